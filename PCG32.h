@@ -21,6 +21,33 @@
  * Generate a double type random number that obey standard normal distrubution
  * double PCG32StandardNormal(PCG32Struct* status);
  * 
+ * Skewed item popularity, items are numbered [0,items), theta in (0,1), YCSB uses 0.99
+ * bool PCG32ZipfianInit(PCG32ZipfianStruct* zipfian,long long unsigned int items,double theta);
+ * Change the item count, growing only adds the new terms to zeta
+ * void PCG32ZipfianSetItems(PCG32ZipfianStruct* zipfian,long long unsigned int items);
+ * Item 0 is the most popular, then 1, 2, ...
+ * long long unsigned int PCG32Zipfian(PCG32Struct* status,const PCG32ZipfianStruct* zipfian);
+ * Same popularity but popular items are spread over the whole range by a hash
+ * long long unsigned int PCG32ScrambledZipfian(PCG32Struct* status,const PCG32ZipfianStruct* zipfian);
+ * The most recent (biggest) item is the most popular
+ * long long unsigned int PCG32Latest(PCG32Struct* status,const PCG32ZipfianStruct* zipfian);
+ * hotOperationFraction of the draws fall uniformly into the first hotSetFraction of the items, the rest into the others
+ * long long unsigned int PCG32Hotspot(PCG32Struct* status,long long unsigned int items,double hotSetFraction,double hotOperationFraction);
+ * 
+ * Seed one of 2^63 independent streams, PCG32SetSeed(status,seed) is PCG32SetStream(status,seed,PCG32DefaultStream)
+ * void PCG32SetStream(PCG32Struct* status,long long unsigned int seed,long long unsigned int stream);
+ * 
+ * Skip delta numbers in O(log(delta)), e.g. thread i of n advances by i*(numbers per thread) from the same seed
+ * void PCG32Advance(PCG32Struct* status,long long unsigned int delta);
+ * 
+ * Fill an array with the next count numbers, the same as count calls of PCG32(), 8 lanes at a time with AVX2
+ * void PCG32Fill(PCG32Struct* status,unsigned* array,long long unsigned int count);
+ * Fill with 64-bit numbers made of two consecutive numbers, the first one in the high half
+ * void PCG32Fill64(PCG32Struct* status,long long unsigned int* array,long long unsigned int count);
+ * 
+ * Shuffle with several threads (C++ only), see the note at its definition
+ * void PCG32ParallelUniformShuffle(PCG32Struct* status,Type* array,long long unsigned int length,unsigned threads=0);
+ * 
  * Example:
  * 
  * PCG32Struct PCGStatus;
@@ -30,7 +57,8 @@
  * Note:
  * 
  * Remember to set the seed.
- * Use its own PCG32Struct in each thread function and set different seed. 
+ * Use its own PCG32Struct in each thread function and set different seed, or the same seed with different streams. 
+ * Build with -mavx2 (or -march=native) for the vectorized PCG32Fill. 
  * 
 */
 
@@ -54,6 +82,9 @@
     #define PCG32_HOST
 	#include <math.h>
 	#include <stdbool.h>
+	#if defined(__AVX2__)
+		#include <immintrin.h>
+	#endif
 #endif
 
 #if PCG32_CUDA
@@ -87,8 +118,12 @@ typedef struct _PCG32Struct{
 	double gammaBeta;
 	double gammaNegativeSqrt9AlphaSub3;
 	unsigned normalDistributionSavedValid;
+	long long unsigned int streamIncrement;  // odd, selects the stream
 }PCG32Struct;
 
+// the stream of the classic increment 1442695040888963407
+#define PCG32DefaultStream 721347520444481703LLU
+
 PCG32_HOST_DEVICE static inline unsigned rotr32(unsigned x,unsigned r){
 	return x>>r|x<<(-r&31);
 }
@@ -96,7 +131,7 @@ PCG32_HOST_DEVICE static inline unsigned rotr32(unsigned x,unsigned r){
 PCG32_HOST_DEVICE static inline unsigned PCG32(PCG32Struct* status){
 	long long unsigned int x=status->state;
 	unsigned count=(unsigned)(x>>59);
-	status->state=x*multiplier+increment;
+	status->state=x*multiplier+status->streamIncrement;
 	x=x^(x>>18);
 	return rotr32((unsigned)(x>>27),count);
 }
@@ -202,6 +237,7 @@ PCG32_HOST_DEVICE static inline double PCG32Gamma(PCG32Struct* status){
 }
 
 PCG32_HOST_DEVICE static inline void PCG32Init(PCG32Struct* status){
+	status->streamIncrement=increment;
 	status->state=status->seed+increment;
 	status->normalDistributionSavedValid=PCG32False;
 	PCG32(status);
@@ -212,12 +248,218 @@ PCG32_HOST_DEVICE static inline void PCG32SetSeed(PCG32Struct* status,long long
 	PCG32Init(status);
 }
 
+PCG32_HOST_DEVICE static inline void PCG32SetStream(PCG32Struct* status,long long unsigned int seed,long long unsigned int stream){
+	status->seed=seed;
+	status->streamIncrement=(stream<<1)|1;
+	status->state=seed+status->streamIncrement;
+	status->normalDistributionSavedValid=PCG32False;
+	PCG32(status);
+}
+
+// the affine map of delta steps: state -> state*jumpMultiplier+jumpIncrement (Brown, "Random number generation with arbitrary strides")
+PCG32_HOST_DEVICE static inline void PCG32Jump(long long unsigned int delta,long long unsigned int streamIncrement,long long unsigned int* jumpMultiplier,long long unsigned int* jumpIncrement){
+	long long unsigned int accumulatedMultiplier=1;
+	long long unsigned int accumulatedIncrement=0;
+	long long unsigned int currentMultiplier=multiplier;
+	long long unsigned int currentIncrement=streamIncrement;
+	while(delta>0){
+		if(delta&1){
+			accumulatedMultiplier=accumulatedMultiplier*currentMultiplier;
+			accumulatedIncrement=accumulatedIncrement*currentMultiplier+currentIncrement;
+		}
+		currentIncrement=(currentMultiplier+1)*currentIncrement;
+		currentMultiplier=currentMultiplier*currentMultiplier;
+		delta=delta>>1;
+	}
+	*jumpMultiplier=accumulatedMultiplier;
+	*jumpIncrement=accumulatedIncrement;
+}
+
+PCG32_HOST_DEVICE static inline void PCG32Advance(PCG32Struct* status,long long unsigned int delta){
+	long long unsigned int jumpMultiplier,jumpIncrement;
+	PCG32Jump(delta,status->streamIncrement,&jumpMultiplier,&jumpIncrement);
+	status->state=status->state*jumpMultiplier+jumpIncrement;
+}
+
+PCG32_HOST_DEVICE static inline unsigned PCG32Output(long long unsigned int x){
+	unsigned count=(unsigned)(x>>59);
+	x=x^(x>>18);
+	return rotr32((unsigned)(x>>27),count);
+}
+
+#if defined(__AVX2__)&&!PCG32_CUDA
+// low 64 bits of the lane products, AVX2 only multiplies 32x32
+static inline __m256i PCG32Multiply64(__m256i a,__m256i b,__m256i bHigh){
+	__m256i cross=_mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a,32),b),_mm256_mul_epu32(a,bHigh));
+	return _mm256_add_epi64(_mm256_mul_epu32(a,b),_mm256_slli_epi64(cross,32));
+}
+
+// PCG32Output of 4 states, the results in the low halves of the lanes
+static inline __m256i PCG32Output4(__m256i x){
+	__m256i count=_mm256_srli_epi64(x,59);
+	x=_mm256_xor_si256(x,_mm256_srli_epi64(x,18));
+	x=_mm256_and_si256(_mm256_srli_epi64(x,27),_mm256_set1_epi64x(0xFFFFFFFFLL));
+	__m256i rotated=_mm256_or_si256(_mm256_srlv_epi64(x,count),_mm256_sllv_epi64(x,_mm256_sub_epi64(_mm256_set1_epi64x(32),count)));
+	return _mm256_and_si256(rotated,_mm256_set1_epi64x(0xFFFFFFFFLL));
+}
+#endif
+
+// lane k of 8 produces numbers k, k+8, k+16, ... so the array holds the sequence in order
+PCG32_HOST_DEVICE static inline void PCG32Fill(PCG32Struct* status,unsigned* array,long long unsigned int count){
+	long long unsigned int index=0;
+	if(count>=32){
+		long long unsigned int lanes[8];
+		long long unsigned int stepMultiplier,stepIncrement,oneMultiplier,oneIncrement;
+		PCG32Jump(8,status->streamIncrement,&stepMultiplier,&stepIncrement);
+		PCG32Jump(1,status->streamIncrement,&oneMultiplier,&oneIncrement);
+		lanes[0]=status->state;
+		for(unsigned lane=1;lane<8;lane=lane+1){
+			lanes[lane]=lanes[lane-1]*oneMultiplier+oneIncrement;
+		}
+		const long long unsigned int blocks=count/8;
+#if defined(__AVX2__)&&!PCG32_CUDA
+		__m256i low=_mm256_loadu_si256((const __m256i*)lanes);
+		__m256i high=_mm256_loadu_si256((const __m256i*)(lanes+4));
+		const __m256i vectorMultiplier=_mm256_set1_epi64x((long long)stepMultiplier);
+		const __m256i vectorMultiplierHigh=_mm256_set1_epi64x((long long)(stepMultiplier>>32));
+		const __m256i vectorIncrement=_mm256_set1_epi64x((long long)stepIncrement);
+		const __m256i gather=_mm256_setr_epi32(0,2,4,6,1,3,5,7);
+		for(long long unsigned int block=0;block<blocks;block=block+1){
+			__m256i lowOutput=_mm256_permutevar8x32_epi32(PCG32Output4(low),gather);
+			__m256i highOutput=_mm256_permutevar8x32_epi32(PCG32Output4(high),gather);
+			_mm256_storeu_si256((__m256i*)(array+block*8),_mm256_permute2x128_si256(lowOutput,highOutput,0x20));
+			low=_mm256_add_epi64(PCG32Multiply64(low,vectorMultiplier,vectorMultiplierHigh),vectorIncrement);
+			high=_mm256_add_epi64(PCG32Multiply64(high,vectorMultiplier,vectorMultiplierHigh),vectorIncrement);
+		}
+		_mm256_storeu_si256((__m256i*)lanes,low);
+#else
+		// independent lanes keep several multiplies in flight instead of one long dependency chain
+		for(long long unsigned int block=0;block<blocks;block=block+1){
+			for(unsigned lane=0;lane<8;lane=lane+1){
+				array[block*8+lane]=PCG32Output(lanes[lane]);
+				lanes[lane]=lanes[lane]*stepMultiplier+stepIncrement;
+			}
+		}
+#endif
+		status->state=lanes[0];
+		index=blocks*8;
+	}
+	for(;index<count;index=index+1){
+		array[index]=PCG32(status);
+	}
+}
+
+PCG32_HOST_DEVICE static inline void PCG32Fill64(PCG32Struct* status,long long unsigned int* array,long long unsigned int count){
+	unsigned buffer[512];
+	for(long long unsigned int index=0;index<count;){
+		long long unsigned int batch=count-index<256?count-index:256;
+		PCG32Fill(status,buffer,batch*2);
+		for(long long unsigned int offset=0;offset<batch;offset=offset+1){
+			array[index+offset]=((long long unsigned int)buffer[offset*2]<<32)|buffer[offset*2+1];
+		}
+		index=index+batch;
+	}
+}
+
+typedef struct _PCG32ZipfianStruct{
+	long long unsigned int items;
+	double theta;
+	double alpha;
+	double zeta2Theta;
+	double zetaN;
+	double eta;
+}PCG32ZipfianStruct;
+
+// zeta(items,theta)=sum of 1/i^theta for i in [1,items], continued from zeta(start,theta)=initial
+PCG32_HOST_DEVICE static inline double PCG32Zeta(long long unsigned int start,long long unsigned int items,double theta,double initial){
+	double sum=initial;
+	for(long long unsigned int index=start;index<items;index=index+1){
+		sum=sum+1.0/pow((double)(index+1),theta);
+	}
+	return sum;
+}
+
+PCG32_HOST_DEVICE static inline void PCG32ZipfianSetItems(PCG32ZipfianStruct* zipfian,long long unsigned int items){
+	if(items==0){
+		items=1;
+	}
+	if(items>=zipfian->items){
+		zipfian->zetaN=PCG32Zeta(zipfian->items,items,zipfian->theta,zipfian->zetaN);
+	}
+	else{
+		zipfian->zetaN=PCG32Zeta(0,items,zipfian->theta,0.0);
+	}
+	zipfian->items=items;
+	zipfian->eta=(1.0-pow(2.0/(double)items,1.0-zipfian->theta))/(1.0-zipfian->zeta2Theta/zipfian->zetaN);
+}
+
+PCG32_HOST_DEVICE static inline bool PCG32ZipfianInit(PCG32ZipfianStruct* zipfian,long long unsigned int items,double theta){
+	if(theta<=0.0||theta>=1.0){
+		return false;
+	}
+	zipfian->items=0;
+	zipfian->theta=theta;
+	zipfian->alpha=1.0/(1.0-theta);
+	zipfian->zeta2Theta=PCG32Zeta(0,2,theta,0.0);
+	zipfian->zetaN=0.0;
+	PCG32ZipfianSetItems(zipfian,items);
+	return true;
+}
+
+// Gray et al., "Quickly Generating Billion-Record Synthetic Databases", the generator YCSB uses
+PCG32_HOST_DEVICE static inline long long unsigned int PCG32Zipfian(PCG32Struct* status,const PCG32ZipfianStruct* zipfian){
+	const double uniform=PCG32UniformReal(status,0,1);
+	const double uz=uniform*zipfian->zetaN;
+	if(uz<1.0||zipfian->items<2){
+		return 0;
+	}
+	if(uz<1.0+pow(0.5,zipfian->theta)){
+		return 1;
+	}
+	long long unsigned int item=(long long unsigned int)((double)zipfian->items*pow(zipfian->eta*uniform-zipfian->eta+1.0,zipfian->alpha));
+	return item<zipfian->items?item:zipfian->items-1;
+}
+
+PCG32_HOST_DEVICE static inline long long unsigned int PCG32ScrambledZipfian(PCG32Struct* status,const PCG32ZipfianStruct* zipfian){
+	long long unsigned int item=PCG32Zipfian(status,zipfian);
+	// FNV-1a over the 8 bytes of item
+	long long unsigned int hash=14695981039346656037LLU;
+	for(unsigned index=0;index<8;index=index+1){
+		hash=(hash^(item&0xFF))*1099511628211LLU;
+		item=item>>8;
+	}
+	return hash%zipfian->items;
+}
+
+PCG32_HOST_DEVICE static inline long long unsigned int PCG32Latest(PCG32Struct* status,const PCG32ZipfianStruct* zipfian){
+	return zipfian->items-1-PCG32Zipfian(status,zipfian);
+}
+
+PCG32_HOST_DEVICE static inline long long unsigned int PCG32Hotspot(PCG32Struct* status,long long unsigned int items,double hotSetFraction,double hotOperationFraction){
+	long long unsigned int hotItems=(long long unsigned int)((double)items*hotSetFraction);
+	if(hotItems==0){
+		hotItems=1;
+	}
+	if(hotItems>=items||PCG32UniformReal(status,0,1)<hotOperationFraction){
+		return (long long unsigned int)(PCG32UniformReal(status,0,1)*(double)hotItems);
+	}
+	return hotItems+(long long unsigned int)(PCG32UniformReal(status,0,1)*(double)(items-hotItems));
+}
+
 #ifdef __cplusplus
 }
 #endif
 
 #if defined(__cplusplus)||PCG32_CUDA
 
+#if !PCG32_CUDA
+	#include <vector>
+	#include <thread>
+	#include <functional>
+	#include <utility>
+	#include <algorithm>
+#endif
+
 template<typename Type>
 PCG32_HOST_DEVICE static inline void PCG32SWAP(Type* array,long long unsigned int index0,long long unsigned int index1){
 	const Type tempory=array[index0];                                                                            
@@ -234,6 +476,87 @@ PCG32_HOST_DEVICE static inline void PCG32UniformShuffle(PCG32Struct* status,Typ
     }   
 }
 
+#if !PCG32_CUDA
+
+// Every element goes to one of 64 buckets drawn at random, the buckets are laid out one after another and each is
+// Fisher-Yates shuffled on its own, which is still a uniform permutation. Chunk c draws its buckets from stream c and
+// bucket b is shuffled with stream 64+b of a seed taken from status, so the result depends on status and length only,
+// not on threads (0: std::thread::hardware_concurrency()). Needs a second array of length elements and length bytes,
+// Type must be default constructible and move assignable. Below 65536 elements it is PCG32UniformShuffle.
+template<typename Type>
+static inline void PCG32ParallelUniformShuffle(PCG32Struct* status,Type* array,long long unsigned int length,unsigned threads=0){
+	const unsigned buckets=64;
+	if(length<65536){
+		PCG32UniformShuffle(status,array,length);
+		return;
+	}
+	long long unsigned int seed=((long long unsigned int)PCG32(status)<<32)|PCG32(status);
+	if(threads==0){
+		threads=std::thread::hardware_concurrency();
+	}
+	threads=threads<1?1:threads>buckets?buckets:threads;
+	auto run=[threads](const std::function<void(unsigned)>& job){
+		std::vector<std::thread> workers;
+		for(unsigned thread=1;thread<threads;thread=thread+1){
+			workers.emplace_back([&job,thread,threads](){
+				for(unsigned part=thread;part<buckets;part=part+threads){
+					job(part);
+				}
+			});
+		}
+		for(unsigned part=0;part<buckets;part=part+threads){
+			job(part);
+		}
+		for(std::thread& worker:workers){
+			worker.join();
+		}
+	};
+	auto chunkBegin=[length](unsigned chunk){
+		return length*chunk/buckets;
+	};
+	std::vector<unsigned char> target(length);
+	std::vector<long long unsigned int> offsets(buckets*buckets,0);  // [chunk][bucket]
+	run([&](unsigned chunk){
+		PCG32Struct stream;
+		PCG32SetStream(&stream,seed,chunk);
+		long long unsigned int* counts=offsets.data()+chunk*buckets;
+		for(long long unsigned int index=chunkBegin(chunk);index<chunkBegin(chunk+1);index=index+1){
+			unsigned bucket=PCG32(&stream)&(buckets-1);
+			target[index]=(unsigned char)bucket;
+			counts[bucket]=counts[bucket]+1;
+		}
+	});
+	std::vector<long long unsigned int> bucketBegin(buckets+1,0);
+	long long unsigned int position=0;
+	for(unsigned bucket=0;bucket<buckets;bucket=bucket+1){
+		bucketBegin[bucket]=position;
+		for(unsigned chunk=0;chunk<buckets;chunk=chunk+1){
+			long long unsigned int count=offsets[chunk*buckets+bucket];
+			offsets[chunk*buckets+bucket]=position;
+			position=position+count;
+		}
+	}
+	bucketBegin[buckets]=position;
+	std::vector<Type> scattered(length);
+	run([&](unsigned chunk){
+		long long unsigned int* next=offsets.data()+chunk*buckets;
+		for(long long unsigned int index=chunkBegin(chunk);index<chunkBegin(chunk+1);index=index+1){
+			scattered[next[target[index]]]=std::move(array[index]);
+			next[target[index]]=next[target[index]]+1;
+		}
+	});
+	run([&](unsigned bucket){
+		PCG32Struct stream;
+		PCG32SetStream(&stream,seed,buckets+bucket);
+		Type* begin=scattered.data()+bucketBegin[bucket];
+		long long unsigned int count=bucketBegin[bucket+1]-bucketBegin[bucket];
+		PCG32UniformShuffle(&stream,begin,count);
+		std::move(begin,begin+count,array+bucketBegin[bucket]);
+	});
+}
+
+#endif
+
 #else
 
 #define GENERATE_FOR_TYPE(TypeName,Type)                                                                         \
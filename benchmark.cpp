@@ -0,0 +1,2138 @@
+// RBTreeArray microbenchmarks
+//
+// Build: g++ -std=c++17 -O2 -pthread benchmark.cpp -o benchmark
+// Run:   ./benchmark [--size N] [--warmup N] [--repetitions N] [--seed N] [--cpu N] [--filter TEXT] [--format table|csv|json] [--output FILE]
+//                    [--distribution uniform|zipfian|hotspot|latest|sequential] [--mix read=N,update=N,insert=N,scan=N,rmw=N,delete=N] [--counters]
+//                    [--threads LIST] [--thread-cpus LIST] [--numa-memory local|interleave|NODE] [--replay FILE] [--memory] [--list]
+//
+// Every case is a (operation, tree, key type, value type) combination. A case is run --warmup times untimed, then
+// --repetitions times timed as a whole batch (ns/op and throughput come from these), then once more with every
+// operation timed on its own for the latency percentiles. The clock read overhead is measured at start up and
+// subtracted from single operation samples. With --counters, cycles, instructions, L1D/LLC/branch/dTLB misses per
+// operation are read from perf_event_open over the timed repetitions (Linux only, unavailable counters are left empty).
+//
+// The ycsb_* cases follow the YCSB core workloads: load --size records, then replay --size requests drawn from the
+// workload's operation mix and key distribution against RBTreeArray16/32/64 and std::map.
+//
+// The mt_* cases share one tree among --threads readers pinned to --thread-cpus, --numa-memory places the memory
+// of the trees (lists are written like "0-3,8", a malformed list prints the usage). --counters includes the readers.
+//
+// --replay runs a trace written by RBTreeArrayRecorder (RBTREE_ARRAY_RECORD=1) instead of the built-in cases: the keys
+// present when the recorder was attached are loaded untimed, then every recorded call is re-executed on RBTreeArray16
+// (if the keys fit), RBTreeArray32 as constructed, with incremental growth and presized, RBTreeArray64 and std::map.
+//
+// --memory measures heap instead of time: tree blocks (RBTREE_ARRAY_MALLOC and friends) and operator new are counted
+// by usable size while a case runs. Each case inserts --size keys (bytes per entry, peak during growth), deletes half,
+// churns four rounds of inserting and deleting half the keys back to the same keys, and compares the result with a
+// fresh store holding them, configured and shrunk like the churned one (fragmentation). RBTreeArray16/32/64 are
+// compared with std::map, std::unordered_map and a sorted std::vector.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <atomic>
+#include <new>
+#include <unordered_map>
+
+#if defined(__linux__)
+    #include <malloc.h>
+    #include <sched.h>
+    #include <unistd.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <linux/perf_event.h>
+    #include <linux/mempolicy.h>
+#endif
+
+// tree blocks go through the counting allocator of the memory cases, as do std containers through operator new below
+void* BenchmarkCountedMalloc(size_t size)noexcept;
+void* BenchmarkCountedRealloc(void* pointer,size_t size)noexcept;
+void BenchmarkCountedFree(void* pointer)noexcept;
+#define RBTREE_ARRAY_MALLOC BenchmarkCountedMalloc
+#define RBTREE_ARRAY_REALLOC BenchmarkCountedRealloc
+#define RBTREE_ARRAY_FREE BenchmarkCountedFree
+
+#include "PCG32.h"
+#include "RBTreeArrayCXX.h"
+
+struct BenchmarkOptions{
+    uint64_t size=1000000;
+    uint64_t warmup=1;
+    uint64_t repetitions=5;
+    int cpu=-1;
+    std::string filter;
+    std::string format="table";
+    std::string output;
+    bool list=false;
+    uint64_t seed=20240601;
+    std::string distribution;    // overrides the key distribution of every YCSB workload when set
+    std::string mix;             // extra YCSB workload, e.g. "read=60,update=20,insert=10,delete=10"
+    bool counters=false;         // hardware counters around the timed repetitions
+    std::string replay;          // trace written by RBTreeArrayRecorder, replaces the built-in cases
+    bool memory=false;           // bytes per entry, growth peaks and churn instead of timings
+    std::string threads;         // thread counts of the concurrent read cases, e.g. "1,2,4,8", default doubles up to the allowed CPUs
+    std::string threadCPUs;      // CPUs the reader threads are pinned to in order, e.g. "0-7,16-23", default the allowed CPUs
+    std::string numaMemory="local";  // memory policy: local (first touch), interleave (all nodes) or a node number
+};
+
+struct BenchmarkResult{
+    std::string name;
+    std::string treeName;
+    uint64_t size;
+    uint64_t operations;
+    uint64_t repetitions;
+    double nsPerOperation;       // median over repetitions
+    double nsPerOperationMin;
+    double nsPerOperationStddev;
+    double operationsPerSecond;  // from the median
+    std::vector<double> samples; // ns per operation of every timed repetition, in run order
+    bool latency;                // false when operations are too short to time one by one
+    double p50,p90,p99,p999,max;
+    bool counters;
+    double counterPerOperation[6];   // negative when the counter is not available
+};
+
+template<typename Type>
+inline void BenchmarkDoNotOptimize(const Type& value){
+#if defined(__GNUC__)||defined(__clang__)
+    asm volatile(""::"g"(&value):"memory");
+#else
+    static volatile const void* sink;
+    sink=&value;
+#endif
+}
+
+inline uint64_t BenchmarkNow(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline double BenchmarkClockOverhead(){
+    const uint64_t count=1<<20;
+    uint64_t start=BenchmarkNow();
+    for(uint64_t index=0;index<count;index=index+1){
+        uint64_t now=BenchmarkNow();
+        BenchmarkDoNotOptimize(now);
+    }
+    return double(BenchmarkNow()-start)/count;
+}
+
+// Heap bytes allocated while enabled, by malloc_usable_size so that allocator rounding is included. Blocks allocated
+// before Reset() and freed after it are subtracted too, the memory cases create everything they measure inside the window.
+struct BenchmarkAllocationCounter{
+    std::atomic<bool> enabled{false};
+    std::atomic<int64_t> bytes{0};
+    std::atomic<int64_t> peak{0};
+    std::atomic<uint64_t> allocations{0};
+
+    void Reset(){
+        bytes.store(0,std::memory_order_relaxed);
+        peak.store(0,std::memory_order_relaxed);
+        allocations.store(0,std::memory_order_relaxed);
+        enabled.store(true,std::memory_order_relaxed);
+    }
+    void Stop(){
+        enabled.store(false,std::memory_order_relaxed);
+    }
+    // peak is restarted from the current bytes
+    void ResetPeak(){
+        peak.store(bytes.load(std::memory_order_relaxed),std::memory_order_relaxed);
+    }
+    void Add(void* pointer){
+        if(!pointer||!enabled.load(std::memory_order_relaxed)){
+            return;
+        }
+        const int64_t size=int64_t(UsableSize(pointer));
+        int64_t current=bytes.fetch_add(size,std::memory_order_relaxed)+size;
+        int64_t highest=peak.load(std::memory_order_relaxed);
+        while(current>highest&&!peak.compare_exchange_weak(highest,current,std::memory_order_relaxed)){
+        }
+        allocations.fetch_add(1,std::memory_order_relaxed);
+    }
+    void Remove(void* pointer){
+        if(pointer&&enabled.load(std::memory_order_relaxed)){
+            bytes.fetch_sub(int64_t(UsableSize(pointer)),std::memory_order_relaxed);
+        }
+    }
+    static size_t UsableSize(void* pointer){
+#if defined(__linux__)
+        return malloc_usable_size(pointer);
+#else
+        return 0;
+#endif
+    }
+    static bool Available(){
+#if defined(__linux__)
+        return true;
+#else
+        return false;
+#endif
+    }
+};
+
+inline BenchmarkAllocationCounter& BenchmarkAllocations(){
+    static BenchmarkAllocationCounter counter;
+    return counter;
+}
+
+void* BenchmarkCountedMalloc(size_t size)noexcept{
+    void* pointer=malloc(size);
+    BenchmarkAllocations().Add(pointer);
+    return pointer;
+}
+
+void* BenchmarkCountedRealloc(void* pointer,size_t size)noexcept{
+    BenchmarkAllocations().Remove(pointer);
+    void* newPointer=realloc(pointer,size);
+    BenchmarkAllocations().Add(newPointer?newPointer:pointer);
+    return newPointer;
+}
+
+void BenchmarkCountedFree(void* pointer)noexcept{
+    BenchmarkAllocations().Remove(pointer);
+    free(pointer);
+}
+
+void* operator new(size_t size){
+    void* pointer=BenchmarkCountedMalloc(size?size:1);
+    if(!pointer){
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](size_t size){
+    return operator new(size);
+}
+
+void* operator new(size_t size,const std::nothrow_t&)noexcept{
+    return BenchmarkCountedMalloc(size?size:1);
+}
+
+void* operator new[](size_t size,const std::nothrow_t&)noexcept{
+    return BenchmarkCountedMalloc(size?size:1);
+}
+
+void operator delete(void* pointer)noexcept{
+    BenchmarkCountedFree(pointer);
+}
+
+void operator delete[](void* pointer)noexcept{
+    BenchmarkCountedFree(pointer);
+}
+
+void operator delete(void* pointer,size_t)noexcept{
+    BenchmarkCountedFree(pointer);
+}
+
+void operator delete[](void* pointer,size_t)noexcept{
+    BenchmarkCountedFree(pointer);
+}
+
+// one benchmark case: Prepare() and Release() bracket all runs of the case, Setup() is untimed and runs before every
+// repetition, Run() executes operations [begin,end)
+class BenchmarkCase{
+public:
+    virtual ~BenchmarkCase(){}
+    virtual void Prepare(){}
+    virtual void Release(){}
+    virtual void Setup()=0;
+    virtual void Run(uint64_t begin,uint64_t end)=0;
+    // after Setup(), one sample per operation in nanoseconds without the clock overhead
+    virtual void Latency(std::vector<double>& samples,double clockOverhead){
+        samples.resize(operations);
+        for(uint64_t index=0;index<operations;index=index+1){
+            uint64_t start=BenchmarkNow();
+            Run(index,index+1);
+            uint64_t end=BenchmarkNow();
+            samples[index]=std::max(0.0,double(end-start)-clockOverhead);
+        }
+    }
+    std::string name;
+    std::string treeName;
+    uint64_t size=0;
+    uint64_t operations=0;
+    bool latency=true;
+};
+
+// hardware counters of this thread in user space through perf_event_open, no external tools needed
+// opened with inherit, so threads created later (the readers of the mt_* cases) are counted into the same values
+// each counter is opened on its own so that the kernel can multiplex them, values are scaled by time enabled/running
+enum BenchmarkCounter{
+    BenchmarkCycles,
+    BenchmarkInstructions,
+    BenchmarkL1DMisses,
+    BenchmarkLLCMisses,
+    BenchmarkBranchMisses,
+    BenchmarkDTLBMisses,
+    BenchmarkCounterCount
+};
+
+inline const char* BenchmarkCounterName(unsigned counter){
+    static const char* names[BenchmarkCounterCount]={"cycles","instructions","l1d_misses","llc_misses","branch_misses","dtlb_misses"};
+    return names[counter];
+}
+
+class BenchmarkCounters{
+    int descriptors[BenchmarkCounterCount];
+public:
+    BenchmarkCounters(){
+        for(unsigned index=0;index<BenchmarkCounterCount;index=index+1){
+            descriptors[index]=-1;
+        }
+#if defined(__linux__)
+        const uint32_t types[BenchmarkCounterCount]={PERF_TYPE_HARDWARE,PERF_TYPE_HARDWARE,PERF_TYPE_HW_CACHE,PERF_TYPE_HARDWARE,PERF_TYPE_HARDWARE,PERF_TYPE_HW_CACHE};
+        const uint64_t configs[BenchmarkCounterCount]={
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_L1D|(PERF_COUNT_HW_CACHE_OP_READ<<8)|(PERF_COUNT_HW_CACHE_RESULT_MISS<<16),
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+            PERF_COUNT_HW_CACHE_DTLB|(PERF_COUNT_HW_CACHE_OP_READ<<8)|(PERF_COUNT_HW_CACHE_RESULT_MISS<<16)
+        };
+        for(unsigned index=0;index<BenchmarkCounterCount;index=index+1){
+            struct perf_event_attr attribute;
+            memset(&attribute,0,sizeof(attribute));
+            attribute.size=sizeof(attribute);
+            attribute.type=types[index];
+            attribute.config=configs[index];
+            attribute.disabled=1;
+            attribute.exclude_kernel=1;
+            attribute.exclude_hv=1;
+            attribute.inherit=1;
+            attribute.read_format=PERF_FORMAT_TOTAL_TIME_ENABLED|PERF_FORMAT_TOTAL_TIME_RUNNING;
+            descriptors[index]=int(syscall(SYS_perf_event_open,&attribute,0,-1,-1,0));
+        }
+#endif
+    }
+    ~BenchmarkCounters(){
+#if defined(__linux__)
+        for(unsigned index=0;index<BenchmarkCounterCount;index=index+1){
+            if(descriptors[index]>=0){
+                close(descriptors[index]);
+            }
+        }
+#endif
+    }
+    BenchmarkCounters(const BenchmarkCounters&)=delete;
+    BenchmarkCounters& operator=(const BenchmarkCounters&)=delete;
+
+    bool Available(unsigned counter)const{
+        return descriptors[counter]>=0;
+    }
+    bool AnyAvailable()const{
+        for(unsigned index=0;index<BenchmarkCounterCount;index=index+1){
+            if(descriptors[index]>=0){
+                return true;
+            }
+        }
+        return false;
+    }
+    void Start(){
+#if defined(__linux__)
+        for(unsigned index=0;index<BenchmarkCounterCount;index=index+1){
+            if(descriptors[index]>=0){
+                ioctl(descriptors[index],PERF_EVENT_IOC_RESET,0);
+                ioctl(descriptors[index],PERF_EVENT_IOC_ENABLE,0);
+            }
+        }
+#endif
+    }
+    void Stop(){
+#if defined(__linux__)
+        for(unsigned index=0;index<BenchmarkCounterCount;index=index+1){
+            if(descriptors[index]>=0){
+                ioctl(descriptors[index],PERF_EVENT_IOC_DISABLE,0);
+            }
+        }
+#endif
+    }
+    // adds the counts since Start() to values, unavailable counters are left alone
+    void Accumulate(double* values)const{
+#if defined(__linux__)
+        for(unsigned index=0;index<BenchmarkCounterCount;index=index+1){
+            uint64_t buffer[3];
+            if(descriptors[index]<0||read(descriptors[index],buffer,sizeof(buffer))!=sizeof(buffer)){
+                continue;
+            }
+            // buffer: value, time enabled, time running
+            if(buffer[2]>0){
+                values[index]=values[index]+double(buffer[0])*double(buffer[1])/double(buffer[2]);
+            }
+        }
+#else
+        (void)values;
+#endif
+    }
+};
+
+inline bool BenchmarkPinToCPU(int cpu){
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu,&set);
+    return sched_setaffinity(0,sizeof(set),&set)==0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// decimal digits only, at most 6 of them
+inline bool BenchmarkParseListNumber(const std::string& text,long& number){
+    if(text.empty()||text.size()>6||text.find_first_not_of("0123456789")!=std::string::npos){
+        return false;
+    }
+    number=strtol(text.c_str(),nullptr,10);
+    return true;
+}
+
+// "0-3,8,10-11" to {0,1,2,3,8,10,11}, the format of cpu and node lists in /sys
+// anything else, empty items, trailing characters or reversed ranges included, is rejected
+inline bool BenchmarkParseList(const std::string& text,std::vector<int>& list){
+    list.clear();
+    uint64_t start=0;
+    while(start<=text.size()){
+        uint64_t end=text.find(',',start);
+        if(end==std::string::npos){
+            end=text.size();
+        }
+        std::string item=text.substr(start,end-start);
+        uint64_t dash=item.find('-');
+        long first;
+        long last;
+        if(!BenchmarkParseListNumber(item.substr(0,dash),first)){
+            return false;
+        }
+        last=first;
+        if(dash!=std::string::npos&&!BenchmarkParseListNumber(item.substr(dash+1),last)){
+            return false;
+        }
+        if(last<first){
+            return false;
+        }
+        for(long value=first;value<=last;value=value+1){
+            list.push_back(int(value));
+        }
+        start=end+1;
+    }
+    return !list.empty();
+}
+
+inline std::vector<int> BenchmarkAllowedCPUs(){
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if(sched_getaffinity(0,sizeof(set),&set)==0){
+        for(int cpu=0;cpu<CPU_SETSIZE;cpu=cpu+1){
+            if(CPU_ISSET(cpu,&set)){
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    if(cpus.empty()){
+        unsigned count=std::max(1u,std::thread::hardware_concurrency());
+        for(unsigned cpu=0;cpu<count;cpu=cpu+1){
+            cpus.push_back(int(cpu));
+        }
+    }
+    return cpus;
+}
+
+// memory policy of the calling thread and of threads it creates later, through set_mempolicy without libnuma
+inline bool BenchmarkSetMemoryPolicy(const std::string& policy){
+    if(policy=="local"){
+        return true;
+    }
+#if defined(__linux__)
+    std::vector<int> nodes;
+    if(policy=="interleave"){
+        FILE* file=fopen("/sys/devices/system/node/online","r");
+        char buffer[256]={0};
+        if(!file){
+            return false;
+        }
+        bool valid=fgets(buffer,sizeof(buffer),file)!=nullptr;
+        fclose(file);
+        std::string online=valid?buffer:"";
+        while(!online.empty()&&(online.back()=='\n'||online.back()==' ')){
+            online.pop_back();
+        }
+        if(!BenchmarkParseList(online,nodes)){
+            return false;
+        }
+    }
+    else if(!BenchmarkParseList(policy,nodes)||nodes.size()!=1){
+        return false;
+    }
+    unsigned long mask[16]={0};
+    const unsigned long maxNode=sizeof(mask)*8;
+    for(int node:nodes){
+        if(node>=int(maxNode)){
+            return false;
+        }
+        mask[node/(sizeof(unsigned long)*8)]|=1UL<<(node%(sizeof(unsigned long)*8));
+    }
+    int mode=policy=="interleave"?MPOL_INTERLEAVE:MPOL_BIND;
+    return syscall(SYS_set_mempolicy,mode,mask,maxNode)==0;
+#else
+    return false;
+#endif
+}
+
+// workers pinned to one CPU each, Run(function) calls function(thread) on every worker and returns when all are done
+class BenchmarkThreadPool{
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::function<void(unsigned)> job;
+    uint64_t generation=0;
+    unsigned remaining=0;
+    bool stop=false;
+
+    void Worker(unsigned thread,int cpu){
+        if(cpu>=0){
+            BenchmarkPinToCPU(cpu);
+        }
+        uint64_t seen=0;
+        while(true){
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock,[&]{return stop||generation!=seen;});
+            if(stop){
+                return;
+            }
+            seen=generation;
+            lock.unlock();
+            job(thread);
+            lock.lock();
+            remaining=remaining-1;
+            if(remaining==0){
+                done.notify_one();
+            }
+        }
+    }
+public:
+    BenchmarkThreadPool(unsigned count,const std::vector<int>& cpus){
+        for(unsigned thread=0;thread<count;thread=thread+1){
+            int cpu=cpus.empty()?-1:cpus[thread%cpus.size()];
+            threads.emplace_back(&BenchmarkThreadPool::Worker,this,thread,cpu);
+        }
+    }
+    ~BenchmarkThreadPool(){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop=true;
+        }
+        wake.notify_all();
+        for(std::thread& thread:threads){
+            thread.join();
+        }
+    }
+    unsigned Size()const{
+        return unsigned(threads.size());
+    }
+    void Run(const std::function<void(unsigned)>& function){
+        std::unique_lock<std::mutex> lock(mutex);
+        job=function;
+        remaining=unsigned(threads.size());
+        generation=generation+1;
+        wake.notify_all();
+        done.wait(lock,[&]{return remaining==0;});
+    }
+};
+
+template<typename Type,typename Enable=void>
+struct BenchmarkType;
+
+template<>
+struct BenchmarkType<uint32_t>{
+    static const char* Name(){return "uint32_t";}
+    static uint32_t Make(uint64_t random){return uint32_t(random);}
+};
+
+template<>
+struct BenchmarkType<uint64_t>{
+    static const char* Name(){return "uint64_t";}
+    static uint64_t Make(uint64_t random){return random;}
+};
+
+template<>
+struct BenchmarkType<int64_t>{
+    static const char* Name(){return "int64_t";}
+    static int64_t Make(uint64_t random){return int64_t(random);}
+};
+
+template<>
+struct BenchmarkType<std::string>{
+    static const char* Name(){return "std::string";}
+    static std::string Make(uint64_t random){
+        char buffer[32];
+        snprintf(buffer,sizeof(buffer),"key:%020llu",(long long unsigned int)random);
+        return std::string(buffer);
+    }
+};
+
+template<typename TreeType>
+struct BenchmarkTree;
+
+template<typename KeyType,typename ValueType,typename IndexType,unsigned BitLength>
+struct BenchmarkTree<RBTreeArray<KeyType,ValueType,IndexType,BitLength>>{
+    static std::string Name(){
+        return "RBTreeArray"+std::to_string(BitLength)+"<"+BenchmarkType<KeyType>::Name()+","+BenchmarkType<ValueType>::Name()+">";
+    }
+};
+
+// distinct keys in random order, plus the same keys shuffled again for lookups and a set of keys not in the tree for neighbor queries
+template<typename KeyType,typename ValueType>
+struct BenchmarkData{
+    std::vector<KeyType> keys;
+    std::vector<KeyType> lookups;
+    std::vector<KeyType> probes;
+    std::vector<ValueType> values;
+
+    BenchmarkData(uint64_t size,uint64_t seed){
+        PCG32Struct status;
+        PCG32SetSeed(&status,seed);
+        std::vector<long long unsigned int> random;
+        while(random.size()<size*2){
+            const size_t filled=random.size();
+            random.resize(size*2);
+            PCG32Fill64(&status,random.data()+filled,size*2-filled);
+            if(std::is_same<KeyType,uint32_t>::value){
+                for(size_t index=filled;index<random.size();index=index+1){
+                    random[index]=random[index]&0xFFFFFFFFLLU;
+                }
+            }
+            std::sort(random.begin(),random.end());
+            random.erase(std::unique(random.begin(),random.end()),random.end());
+        }
+        PCG32ParallelUniformShuffle(&status,random.data(),random.size());
+        keys.reserve(size);
+        probes.reserve(size);
+        values.reserve(size);
+        for(uint64_t index=0;index<size;index=index+1){
+            keys.push_back(BenchmarkType<KeyType>::Make(random[index]));
+            probes.push_back(BenchmarkType<KeyType>::Make(random[size+index]));
+            values.push_back(BenchmarkType<ValueType>::Make(index));
+        }
+        lookups=keys;
+        PCG32ParallelUniformShuffle(&status,lookups.data(),lookups.size());
+    }
+};
+
+template<typename TreeType,typename KeyType,typename ValueType>
+class BenchmarkTreeCase:public BenchmarkCase{
+protected:
+    uint64_t seed;
+    std::unique_ptr<BenchmarkData<KeyType,ValueType>> data;
+    TreeType tree;
+
+    void Fill(){
+        if(tree.KeyCount()==size){
+            return;
+        }
+        tree.Clear();
+        for(uint64_t index=0;index<size;index=index+1){
+            tree.Insert(data->keys[index],data->values[index]);
+        }
+    }
+public:
+    BenchmarkTreeCase(const char* caseName,uint64_t caseSize,uint64_t caseSeed){
+        name=caseName;
+        treeName=BenchmarkTree<TreeType>::Name();
+        size=caseSize;
+        operations=caseSize;
+        seed=caseSeed;
+    }
+    void Prepare()override{
+        data.reset(new BenchmarkData<KeyType,ValueType>(size,seed));
+    }
+    void Release()override{
+        data.reset();
+        tree=TreeType();
+    }
+};
+
+template<typename TreeType,typename KeyType,typename ValueType>
+class BenchmarkInsert:public BenchmarkTreeCase<TreeType,KeyType,ValueType>{
+public:
+    BenchmarkInsert(uint64_t size,uint64_t seed):BenchmarkTreeCase<TreeType,KeyType,ValueType>("insert",size,seed){}
+    void Setup()override{
+        this->tree=TreeType();
+    }
+    void Run(uint64_t begin,uint64_t end)override{
+        for(uint64_t index=begin;index<end;index=index+1){
+            this->tree.Insert(this->data->keys[index],this->data->values[index]);
+        }
+    }
+};
+
+template<typename TreeType,typename KeyType,typename ValueType>
+class BenchmarkSearch:public BenchmarkTreeCase<TreeType,KeyType,ValueType>{
+public:
+    BenchmarkSearch(uint64_t size,uint64_t seed):BenchmarkTreeCase<TreeType,KeyType,ValueType>("search",size,seed){}
+    void Setup()override{
+        this->Fill();
+    }
+    void Run(uint64_t begin,uint64_t end)override{
+        ValueType value;
+        for(uint64_t index=begin;index<end;index=index+1){
+            bool found=this->tree.Search(this->data->lookups[index],value);
+            BenchmarkDoNotOptimize(found);
+            BenchmarkDoNotOptimize(value);
+        }
+    }
+};
+
+template<typename TreeType,typename KeyType,typename ValueType>
+class BenchmarkDelete:public BenchmarkTreeCase<TreeType,KeyType,ValueType>{
+public:
+    BenchmarkDelete(uint64_t size,uint64_t seed):BenchmarkTreeCase<TreeType,KeyType,ValueType>("delete",size,seed){}
+    void Setup()override{
+        this->Fill();
+    }
+    void Run(uint64_t begin,uint64_t end)override{
+        for(uint64_t index=begin;index<end;index=index+1){
+            this->tree.Delete(this->data->lookups[index]);
+        }
+    }
+};
+
+// one operation is one element visited, Run(begin,end) visits end-begin elements from the start of the tree
+template<typename TreeType,typename KeyType,typename ValueType>
+class BenchmarkIterate:public BenchmarkTreeCase<TreeType,KeyType,ValueType>{
+    bool ordered;
+public:
+    BenchmarkIterate(uint64_t size,uint64_t seed,bool iterateOrdered):BenchmarkTreeCase<TreeType,KeyType,ValueType>(iterateOrdered?"ordered_iterate":"iterate",size,seed){
+        ordered=iterateOrdered;
+        this->latency=false;
+    }
+    void Setup()override{
+        this->Fill();
+    }
+    void Run(uint64_t begin,uint64_t end)override{
+        uint64_t count=end-begin;
+        uint64_t sum=0;
+        if(ordered){
+            for(auto iterator=this->tree.OrderedBegin();iterator!=this->tree.OrderedEnd()&&count>0;++iterator){
+                sum=sum+uint64_t(iterator.Value());
+                count=count-1;
+            }
+        }
+        else{
+            for(auto iterator=this->tree.begin();iterator!=this->tree.end()&&count>0;++iterator){
+                sum=sum+uint64_t(iterator.Value());
+                count=count-1;
+            }
+        }
+        BenchmarkDoNotOptimize(sum);
+    }
+};
+
+// floor and ceiling of keys that are not in the tree
+template<typename TreeType,typename KeyType,typename ValueType>
+class BenchmarkNeighbors:public BenchmarkTreeCase<TreeType,KeyType,ValueType>{
+public:
+    BenchmarkNeighbors(uint64_t size,uint64_t seed):BenchmarkTreeCase<TreeType,KeyType,ValueType>("neighbors",size,seed){}
+    void Setup()override{
+        this->Fill();
+    }
+    void Run(uint64_t begin,uint64_t end)override{
+        for(uint64_t index=begin;index<end;index=index+1){
+            auto neighbors=this->tree.Neighbors(this->data->probes[index]);
+            BenchmarkDoNotOptimize(neighbors);
+        }
+    }
+};
+
+// one operation is one ConditionalDelete call removing about percent% of a full tree
+template<typename TreeType,typename KeyType,typename ValueType>
+class BenchmarkConditionalDelete:public BenchmarkTreeCase<TreeType,KeyType,ValueType>{
+    uint64_t percent;
+public:
+    BenchmarkConditionalDelete(uint64_t size,uint64_t seed,uint64_t deletePercent):BenchmarkTreeCase<TreeType,KeyType,ValueType>("",size,seed){
+        percent=deletePercent;
+        this->name="conditional_delete_"+std::to_string(percent);
+        this->operations=1;
+        this->latency=false;
+    }
+    void Setup()override{
+        this->Fill();
+    }
+    void Run(uint64_t begin,uint64_t end)override{
+        const uint64_t threshold=percent;
+        for(uint64_t index=begin;index<end;index=index+1){
+            uint64_t deleted=this->tree.ConditionalDelete([threshold](const KeyType& key,const ValueType& value){return uint64_t(value)%100<threshold;});
+            BenchmarkDoNotOptimize(deleted);
+        }
+    }
+};
+
+// one tree shared by threads that only read it: Search, Neighbors, or an ordered scan of 16 keys from the ceiling
+// operations are split evenly between the threads, ns/op and ops/s are aggregate, latency samples come from all
+// threads running at the same time, each thread keeps its samples and results in its own allocation
+template<typename TreeType,typename KeyType,typename ValueType>
+class BenchmarkConcurrentRead:public BenchmarkTreeCase<TreeType,KeyType,ValueType>{
+public:
+    enum Kind{Search,Neighbors,Scan};
+private:
+    Kind kind;
+    unsigned threadCount;
+    std::vector<int> cpus;
+    std::unique_ptr<BenchmarkThreadPool> pool;
+
+    void Work(uint64_t begin,uint64_t end){
+        const TreeType& tree=this->tree;
+        uint64_t sum=0;
+        for(uint64_t index=begin;index<end;index=index+1){
+            if(kind==Search){
+                ValueType value;
+                bool found=tree.Search(this->data->lookups[index],value);
+                BenchmarkDoNotOptimize(found);
+                BenchmarkDoNotOptimize(value);
+            }
+            else if(kind==Neighbors){
+                auto neighbors=tree.Neighbors(this->data->probes[index]);
+                BenchmarkDoNotOptimize(neighbors);
+            }
+            else{
+                uint64_t length=16;
+                for(auto iterator=tree.Neighbors(this->data->probes[index]).second;iterator!=tree.OrderedEnd()&&length>0;++iterator){
+                    sum=sum+uint64_t(iterator.Value());
+                    length=length-1;
+                }
+            }
+        }
+        BenchmarkDoNotOptimize(sum);
+    }
+    static const char* KindName(Kind kind){
+        return kind==Search?"mt_search":kind==Neighbors?"mt_neighbors":"mt_scan";
+    }
+public:
+    BenchmarkConcurrentRead(uint64_t size,uint64_t seed,Kind caseKind,unsigned caseThreads,const std::vector<int>& caseCPUs):BenchmarkTreeCase<TreeType,KeyType,ValueType>(KindName(caseKind),size,seed){
+        kind=caseKind;
+        threadCount=caseThreads;
+        cpus=caseCPUs;
+        this->name=this->name+"_t"+std::to_string(threadCount);
+    }
+    void Prepare()override{
+        BenchmarkTreeCase<TreeType,KeyType,ValueType>::Prepare();
+        pool.reset(new BenchmarkThreadPool(threadCount,cpus));
+    }
+    void Release()override{
+        pool.reset();
+        BenchmarkTreeCase<TreeType,KeyType,ValueType>::Release();
+    }
+    void Setup()override{
+        this->Fill();
+    }
+    void Run(uint64_t begin,uint64_t end)override{
+        const uint64_t count=end-begin;
+        pool->Run([&](unsigned thread){
+            Work(begin+count*thread/threadCount,begin+count*(thread+1)/threadCount);
+        });
+    }
+    void Latency(std::vector<double>& samples,double clockOverhead)override{
+        std::vector<std::vector<double>> threadSamples(threadCount);
+        const uint64_t count=this->operations;
+        pool->Run([&](unsigned thread){
+            const uint64_t begin=count*thread/threadCount;
+            const uint64_t end=count*(thread+1)/threadCount;
+            std::vector<double> local(end-begin);
+            for(uint64_t index=begin;index<end;index=index+1){
+                uint64_t start=BenchmarkNow();
+                Work(index,index+1);
+                uint64_t stop=BenchmarkNow();
+                local[index-begin]=std::max(0.0,double(stop-start)-clockOverhead);
+            }
+            threadSamples[thread].swap(local);
+        });
+        samples.clear();
+        for(const std::vector<double>& local:threadSamples){
+            samples.insert(samples.end(),local.begin(),local.end());
+        }
+    }
+};
+
+template<typename TreeType,typename KeyType,typename ValueType>
+void BenchmarkRegisterConcurrent(std::vector<std::unique_ptr<BenchmarkCase>>& cases,uint64_t size,uint64_t seed,const std::vector<int>& threadCounts,const std::vector<int>& cpus){
+    typedef BenchmarkConcurrentRead<TreeType,KeyType,ValueType> CaseType;
+    for(typename CaseType::Kind kind:{CaseType::Search,CaseType::Neighbors,CaseType::Scan}){
+        for(int threads:threadCounts){
+            cases.emplace_back(new CaseType(size,seed,kind,unsigned(threads),cpus));
+        }
+    }
+}
+
+template<typename TreeType,typename KeyType,typename ValueType>
+void BenchmarkRegister(std::vector<std::unique_ptr<BenchmarkCase>>& cases,uint64_t size,uint64_t seed){
+    cases.emplace_back(new BenchmarkInsert<TreeType,KeyType,ValueType>(size,seed));
+    cases.emplace_back(new BenchmarkSearch<TreeType,KeyType,ValueType>(size,seed));
+    cases.emplace_back(new BenchmarkDelete<TreeType,KeyType,ValueType>(size,seed));
+    cases.emplace_back(new BenchmarkIterate<TreeType,KeyType,ValueType>(size,seed,false));
+    cases.emplace_back(new BenchmarkIterate<TreeType,KeyType,ValueType>(size,seed,true));
+    cases.emplace_back(new BenchmarkNeighbors<TreeType,KeyType,ValueType>(size,seed));
+    cases.emplace_back(new BenchmarkConditionalDelete<TreeType,KeyType,ValueType>(size,seed,10));
+    cases.emplace_back(new BenchmarkConditionalDelete<TreeType,KeyType,ValueType>(size,seed,90));
+}
+
+enum class BenchmarkOperation:uint8_t{Read,Update,Insert,Scan,ReadModifyWrite,Delete};
+
+enum class BenchmarkDistribution:uint8_t{Uniform,Zipfian,Hotspot,Latest,Sequential};
+
+inline const char* BenchmarkDistributionName(BenchmarkDistribution distribution){
+    switch(distribution){
+        case BenchmarkDistribution::Uniform:return "uniform";
+        case BenchmarkDistribution::Zipfian:return "zipfian";
+        case BenchmarkDistribution::Hotspot:return "hotspot";
+        case BenchmarkDistribution::Latest:return "latest";
+        default:return "sequential";
+    }
+}
+
+inline bool BenchmarkParseDistribution(const std::string& name,BenchmarkDistribution& distribution){
+    for(uint8_t index=0;index<=uint8_t(BenchmarkDistribution::Sequential);index=index+1){
+        if(name==BenchmarkDistributionName(BenchmarkDistribution(index))){
+            distribution=BenchmarkDistribution(index);
+            return true;
+        }
+    }
+    return false;
+}
+
+// operation mix in percent, the YCSB core workloads A-F plus an optional custom one
+struct BenchmarkWorkload{
+    std::string name;
+    double read=0;
+    double update=0;
+    double insert=0;
+    double scan=0;
+    double readModifyWrite=0;
+    double remove=0;
+    BenchmarkDistribution distribution=BenchmarkDistribution::Zipfian;
+    uint64_t maxScanLength=100;
+};
+
+inline bool BenchmarkParseMix(const std::string& mix,BenchmarkWorkload& workload){
+    workload=BenchmarkWorkload();
+    workload.name="custom";
+    uint64_t start=0;
+    double total=0;
+    while(start<mix.size()){
+        uint64_t end=mix.find(',',start);
+        if(end==std::string::npos){
+            end=mix.size();
+        }
+        std::string item=mix.substr(start,end-start);
+        uint64_t equal=item.find('=');
+        if(equal==std::string::npos){
+            return false;
+        }
+        std::string operation=item.substr(0,equal);
+        double percent=atof(item.c_str()+equal+1);
+        if(operation=="read"){
+            workload.read=percent;
+        }
+        else if(operation=="update"){
+            workload.update=percent;
+        }
+        else if(operation=="insert"){
+            workload.insert=percent;
+        }
+        else if(operation=="scan"){
+            workload.scan=percent;
+        }
+        else if(operation=="rmw"){
+            workload.readModifyWrite=percent;
+        }
+        else if(operation=="delete"){
+            workload.remove=percent;
+        }
+        else{
+            return false;
+        }
+        total=total+percent;
+        start=end+1;
+    }
+    return total>0;
+}
+
+std::vector<BenchmarkWorkload> BenchmarkWorkloads(const BenchmarkOptions& options){
+    std::vector<BenchmarkWorkload> workloads(6);
+    workloads[0].name="a";    // update heavy
+    workloads[0].read=50;
+    workloads[0].update=50;
+    workloads[1].name="b";    // read mostly
+    workloads[1].read=95;
+    workloads[1].update=5;
+    workloads[2].name="c";    // read only
+    workloads[2].read=100;
+    workloads[3].name="d";    // read latest
+    workloads[3].read=95;
+    workloads[3].insert=5;
+    workloads[3].distribution=BenchmarkDistribution::Latest;
+    workloads[4].name="e";    // short ranges
+    workloads[4].scan=95;
+    workloads[4].insert=5;
+    workloads[5].name="f";    // read-modify-write
+    workloads[5].read=50;
+    workloads[5].readModifyWrite=50;
+    BenchmarkWorkload custom;
+    if(!options.mix.empty()&&BenchmarkParseMix(options.mix,custom)){
+        workloads.push_back(custom);
+    }
+    BenchmarkDistribution distribution;
+    if(!options.distribution.empty()&&BenchmarkParseDistribution(options.distribution,distribution)){
+        for(BenchmarkWorkload& workload:workloads){
+            workload.distribution=distribution;
+        }
+    }
+    return workloads;
+}
+
+// record number to key, a bijection so that insert order is not key order
+inline uint64_t BenchmarkRecordKey(uint64_t record){
+    uint64_t key=record+0x9E3779B97F4A7C15LLU;
+    key=(key^(key>>30))*0xBF58476D1CE4E5B9LLU;
+    key=(key^(key>>27))*0x94D049BB133111EBLLU;
+    return key^(key>>31);
+}
+
+struct BenchmarkRequest{
+    uint64_t key;
+    uint32_t scanLength;
+    BenchmarkOperation operation;
+};
+
+// the load phase keys and the request sequence, generated up front so that every store replays the same requests
+struct BenchmarkWorkloadData{
+    std::vector<uint64_t> load;
+    std::vector<BenchmarkRequest> requests;
+
+    BenchmarkWorkloadData(const BenchmarkWorkload& workload,uint64_t records,uint64_t operations,uint64_t seed){
+        PCG32Struct status;
+        PCG32SetSeed(&status,seed);
+        load.reserve(records);
+        for(uint64_t index=0;index<records;index=index+1){
+            load.push_back(BenchmarkRecordKey(index));
+        }
+        const double total=workload.read+workload.update+workload.insert+workload.scan+workload.readModifyWrite+workload.remove;
+        const double bounds[6]={
+            workload.read/total,
+            (workload.read+workload.update)/total,
+            (workload.read+workload.update+workload.insert)/total,
+            (workload.read+workload.update+workload.insert+workload.scan)/total,
+            (workload.read+workload.update+workload.insert+workload.scan+workload.readModifyWrite)/total,
+            1.0
+        };
+        PCG32ZipfianStruct zipfian;
+        PCG32ZipfianInit(&zipfian,records,0.99);
+        uint64_t inserted=records;
+        uint64_t sequential=0;
+        requests.reserve(operations);
+        for(uint64_t index=0;index<operations;index=index+1){
+            BenchmarkRequest request;
+            const double random=PCG32UniformReal(&status,0,1);
+            uint8_t operation=0;
+            while(operation<5&&random>=bounds[operation]){
+                operation=operation+1;
+            }
+            request.operation=BenchmarkOperation(operation);
+            request.scanLength=0;
+            if(request.operation==BenchmarkOperation::Insert){
+                request.key=BenchmarkRecordKey(inserted);
+                inserted=inserted+1;
+                if(workload.distribution==BenchmarkDistribution::Zipfian||workload.distribution==BenchmarkDistribution::Latest){
+                    PCG32ZipfianSetItems(&zipfian,inserted);
+                }
+            }
+            else{
+                uint64_t record;
+                switch(workload.distribution){
+                    case BenchmarkDistribution::Uniform:
+                        record=uint64_t(PCG32UniformReal(&status,0,1)*inserted);
+                        break;
+                    case BenchmarkDistribution::Zipfian:
+                        record=PCG32ScrambledZipfian(&status,&zipfian);
+                        break;
+                    case BenchmarkDistribution::Hotspot:
+                        record=PCG32Hotspot(&status,inserted,0.2,0.8);
+                        break;
+                    case BenchmarkDistribution::Latest:
+                        record=PCG32Latest(&status,&zipfian);
+                        break;
+                    default:
+                        record=sequential%inserted;
+                        sequential=sequential+1;
+                        break;
+                }
+                request.key=BenchmarkRecordKey(record<inserted?record:inserted-1);
+                if(request.operation==BenchmarkOperation::Scan){
+                    request.scanLength=PCG32Uniform(&status,1,unsigned(workload.maxScanLength));
+                }
+            }
+            requests.push_back(request);
+        }
+    }
+};
+
+// the few operations a workload needs, for RBTreeArray and the std::map baseline
+template<typename StoreType>
+struct BenchmarkStore{
+    static void Insert(StoreType& store,uint64_t key,uint64_t value){
+        store.Insert(key,value);
+    }
+    static bool Read(const StoreType& store,uint64_t key,uint64_t& value){
+        return store.Search(key,value);
+    }
+    static void Delete(StoreType& store,uint64_t key){
+        store.Delete(key);
+    }
+    static uint64_t Scan(const StoreType& store,uint64_t key,uint64_t length){
+        uint64_t sum=0;
+        for(auto iterator=store.Neighbors(key).second;iterator!=store.OrderedEnd()&&length>0;++iterator){
+            sum=sum+iterator.Value();
+            length=length-1;
+        }
+        return sum;
+    }
+};
+
+template<>
+struct BenchmarkStore<std::map<uint64_t,uint64_t>>{
+    typedef std::map<uint64_t,uint64_t> StoreType;
+    static void Insert(StoreType& store,uint64_t key,uint64_t value){
+        store[key]=value;
+    }
+    static bool Read(const StoreType& store,uint64_t key,uint64_t& value){
+        auto iterator=store.find(key);
+        if(iterator==store.end()){
+            return false;
+        }
+        value=iterator->second;
+        return true;
+    }
+    static void Delete(StoreType& store,uint64_t key){
+        store.erase(key);
+    }
+    static uint64_t Scan(const StoreType& store,uint64_t key,uint64_t length){
+        uint64_t sum=0;
+        for(auto iterator=store.lower_bound(key);iterator!=store.end()&&length>0;++iterator){
+            sum=sum+iterator->second;
+            length=length-1;
+        }
+        return sum;
+    }
+};
+
+template<typename KeyType,typename ValueType>
+struct BenchmarkTree<std::map<KeyType,ValueType>>{
+    static std::string Name(){
+        return std::string("std::map<")+BenchmarkType<KeyType>::Name()+","+BenchmarkType<ValueType>::Name()+">";
+    }
+};
+
+// Setup() loads the records into an empty store, one operation is one request
+template<typename StoreType>
+class BenchmarkWorkloadCase:public BenchmarkCase{
+    BenchmarkWorkload workload;
+    uint64_t records;
+    uint64_t seed;
+    std::unique_ptr<BenchmarkWorkloadData> data;
+    StoreType store;
+public:
+    BenchmarkWorkloadCase(const BenchmarkWorkload& caseWorkload,uint64_t caseRecords,uint64_t caseSeed){
+        workload=caseWorkload;
+        records=caseRecords;
+        seed=caseSeed;
+        name="ycsb_"+workload.name+"_"+BenchmarkDistributionName(workload.distribution);
+        treeName=BenchmarkTree<StoreType>::Name();
+        size=caseRecords;
+        operations=caseRecords;
+    }
+    void Prepare()override{
+        data.reset(new BenchmarkWorkloadData(workload,records,operations,seed));
+    }
+    void Release()override{
+        data.reset();
+        store=StoreType();
+    }
+    void Setup()override{
+        store=StoreType();
+        for(uint64_t index=0;index<records;index=index+1){
+            BenchmarkStore<StoreType>::Insert(store,data->load[index],index);
+        }
+    }
+    void Run(uint64_t begin,uint64_t end)override{
+        uint64_t value=0;
+        for(uint64_t index=begin;index<end;index=index+1){
+            const BenchmarkRequest& request=data->requests[index];
+            switch(request.operation){
+                case BenchmarkOperation::Read:
+                    BenchmarkStore<StoreType>::Read(store,request.key,value);
+                    break;
+                case BenchmarkOperation::Update:
+                case BenchmarkOperation::Insert:
+                    BenchmarkStore<StoreType>::Insert(store,request.key,index);
+                    break;
+                case BenchmarkOperation::Scan:
+                    value=value+BenchmarkStore<StoreType>::Scan(store,request.key,request.scanLength);
+                    break;
+                case BenchmarkOperation::ReadModifyWrite:
+                    BenchmarkStore<StoreType>::Read(store,request.key,value);
+                    BenchmarkStore<StoreType>::Insert(store,request.key,value+1);
+                    break;
+                case BenchmarkOperation::Delete:
+                    BenchmarkStore<StoreType>::Delete(store,request.key);
+                    break;
+            }
+        }
+        BenchmarkDoNotOptimize(value);
+    }
+};
+
+template<typename KeyType,typename ValueType>
+struct BenchmarkReplayRequest{
+    RBTreeArrayRecordOperation operation;
+    KeyType key;
+    ValueType value;
+    uint64_t size;               // array size of a ReSize request
+};
+
+// a decoded trace: Load records become the starting state, the others the requests
+template<typename KeyType,typename ValueType>
+struct BenchmarkReplayData{
+    std::vector<std::pair<KeyType,ValueType>> load;
+    std::vector<BenchmarkReplayRequest<KeyType,ValueType>> requests;
+    uint64_t nanoseconds=0;      // recorded duration of the requests
+    uint64_t peakKeys=0;         // upper bound of the key count during the replay
+
+    explicit BenchmarkReplayData(const std::vector<char>& trace){
+        RBTreeArrayRecordReader reader(trace.data(),trace.size());
+        BenchmarkReplayRequest<KeyType,ValueType> request;
+        uint64_t nanosecondsSincePrevious;
+        uint64_t keys=0;
+        request.key=KeyType();
+        request.value=ValueType();
+        request.size=0;
+        while(reader.Next(request.operation,nanosecondsSincePrevious,request.key,request.value)){
+            request.size=reader.Size();
+            if(request.operation==RBTreeArrayRecordOperation::Load){
+                load.emplace_back(request.key,request.value);
+                keys=keys+1;
+            }
+            else{
+                if(!requests.empty()){
+                    nanoseconds=nanoseconds+nanosecondsSincePrevious;
+                }
+                requests.push_back(request);
+                if(request.operation==RBTreeArrayRecordOperation::Insert||request.operation==RBTreeArrayRecordOperation::Access){
+                    keys=keys+1;
+                }
+            }
+            peakKeys=std::max(peakKeys,keys);
+        }
+    }
+};
+
+template<typename TreeType,typename KeyType,typename ValueType>
+inline void BenchmarkReplayApply(TreeType& tree,const BenchmarkReplayRequest<KeyType,ValueType>& request){
+    KeyType key;
+    ValueType value;
+    switch(request.operation){
+        case RBTreeArrayRecordOperation::Load:
+        case RBTreeArrayRecordOperation::Insert:
+            tree.Insert(request.key,request.value);
+            break;
+        case RBTreeArrayRecordOperation::Delete:
+            tree.Delete(request.key);
+            break;
+        case RBTreeArrayRecordOperation::Search:
+            BenchmarkDoNotOptimize(tree.Search(request.key,value));
+            break;
+        case RBTreeArrayRecordOperation::Access:
+            BenchmarkDoNotOptimize(tree[request.key]);
+            break;
+        case RBTreeArrayRecordOperation::SmallestGreaterThan:
+            BenchmarkDoNotOptimize(tree.GetSmallestGraterThan(request.key,key,value));
+            break;
+        case RBTreeArrayRecordOperation::BiggestSmallerThan:
+            BenchmarkDoNotOptimize(tree.GetBiggestSmallerThan(request.key,key,value));
+            break;
+        case RBTreeArrayRecordOperation::Neighbors:
+            BenchmarkDoNotOptimize(tree.Neighbors(request.key));
+            break;
+        case RBTreeArrayRecordOperation::Clear:
+            tree.Clear();
+            break;
+        case RBTreeArrayRecordOperation::ReSize:
+            if(request.size<=TreeType::MaxNodeCount){
+                BenchmarkDoNotOptimize(tree.ReSize(request.size));
+            }
+            break;
+    }
+}
+
+template<typename KeyType,typename ValueType>
+inline void BenchmarkReplayApply(std::map<KeyType,ValueType>& map,const BenchmarkReplayRequest<KeyType,ValueType>& request){
+    switch(request.operation){
+        case RBTreeArrayRecordOperation::Load:
+        case RBTreeArrayRecordOperation::Insert:
+            map[request.key]=request.value;
+            break;
+        case RBTreeArrayRecordOperation::Delete:
+            map.erase(request.key);
+            break;
+        case RBTreeArrayRecordOperation::Search:
+            BenchmarkDoNotOptimize(map.find(request.key));
+            break;
+        case RBTreeArrayRecordOperation::Access:
+            BenchmarkDoNotOptimize(map[request.key]);
+            break;
+        case RBTreeArrayRecordOperation::SmallestGreaterThan:
+            BenchmarkDoNotOptimize(map.upper_bound(request.key));
+            break;
+        case RBTreeArrayRecordOperation::BiggestSmallerThan:{
+            auto iterator=map.lower_bound(request.key);
+            BenchmarkDoNotOptimize(iterator==map.begin()?map.end():std::prev(iterator));
+            break;
+        }
+        case RBTreeArrayRecordOperation::Neighbors:{
+            auto ceiling=map.lower_bound(request.key);
+            auto floor=ceiling!=map.end()&&!(request.key<ceiling->first)?ceiling:ceiling==map.begin()?map.end():std::prev(ceiling);
+            BenchmarkDoNotOptimize(floor);
+            BenchmarkDoNotOptimize(ceiling);
+            break;
+        }
+        case RBTreeArrayRecordOperation::Clear:
+            map.clear();
+            break;
+        case RBTreeArrayRecordOperation::ReSize:
+            break;
+    }
+}
+
+template<typename TreeType>
+inline void BenchmarkReplayConfigure(TreeType& tree,const std::string& mode,uint64_t peakKeys){
+    if(mode=="incremental"){
+        tree.SetIncrementalGrowth(64);
+    }
+    else if(mode=="presized"){
+        tree.ReSize(std::max<uint64_t>(peakKeys,1));
+    }
+}
+
+template<typename KeyType,typename ValueType>
+inline void BenchmarkReplayConfigure(std::map<KeyType,ValueType>& map,const std::string& mode,uint64_t peakKeys){
+}
+
+// Setup() rebuilds the recorded starting state in an empty store, one operation is one recorded call
+template<typename StoreType,typename KeyType,typename ValueType>
+class BenchmarkReplayCase:public BenchmarkCase{
+    std::shared_ptr<const std::vector<char>> trace;
+    std::string mode;
+    std::unique_ptr<BenchmarkReplayData<KeyType,ValueType>> data;
+    StoreType store;
+public:
+    // mode: "" as constructed, "incremental" SetIncrementalGrowth(64), "presized" ReSize() to the peak key count first
+    BenchmarkReplayCase(const std::shared_ptr<const std::vector<char>>& caseTrace,const std::string& caseMode,uint64_t requests,uint64_t loaded){
+        trace=caseTrace;
+        mode=caseMode;
+        name=mode.empty()?"replay":"replay_"+mode;
+        treeName=BenchmarkTree<StoreType>::Name();
+        size=loaded;
+        operations=requests;
+    }
+    void Prepare()override{
+        data.reset(new BenchmarkReplayData<KeyType,ValueType>(*trace));
+    }
+    void Release()override{
+        data.reset();
+        store=StoreType();
+    }
+    void Setup()override{
+        store=StoreType();
+        BenchmarkReplayConfigure(store,mode,data->peakKeys);
+        for(const std::pair<KeyType,ValueType>& pair:data->load){
+            BenchmarkReplayRequest<KeyType,ValueType> request={RBTreeArrayRecordOperation::Load,pair.first,pair.second,0};
+            BenchmarkReplayApply(store,request);
+        }
+    }
+    void Run(uint64_t begin,uint64_t end)override{
+        for(uint64_t index=begin;index<end;index=index+1){
+            BenchmarkReplayApply(store,data->requests[index]);
+        }
+    }
+};
+
+template<typename KeyType,typename ValueType>
+bool BenchmarkRegisterReplay(std::vector<std::unique_ptr<BenchmarkCase>>& cases,const std::shared_ptr<const std::vector<char>>& trace){
+    BenchmarkReplayData<KeyType,ValueType> data(*trace);
+    if(data.requests.empty()){
+        return false;
+    }
+    fprintf(stderr,"replay: %zu keys loaded, %zu requests recorded over %.3f seconds, as %s\n",data.load.size(),data.requests.size(),data.nanoseconds/1e9,BenchmarkTree<RBTreeArray32<KeyType,ValueType>>::Name().c_str());
+    const uint64_t requests=data.requests.size();
+    const uint64_t loaded=data.load.size();
+    if(data.peakKeys<60000){
+        cases.emplace_back(new BenchmarkReplayCase<RBTreeArray16<KeyType,ValueType>,KeyType,ValueType>(trace,"",requests,loaded));
+    }
+    cases.emplace_back(new BenchmarkReplayCase<RBTreeArray32<KeyType,ValueType>,KeyType,ValueType>(trace,"",requests,loaded));
+    cases.emplace_back(new BenchmarkReplayCase<RBTreeArray32<KeyType,ValueType>,KeyType,ValueType>(trace,"incremental",requests,loaded));
+    cases.emplace_back(new BenchmarkReplayCase<RBTreeArray32<KeyType,ValueType>,KeyType,ValueType>(trace,"presized",requests,loaded));
+    cases.emplace_back(new BenchmarkReplayCase<RBTreeArray64<KeyType,ValueType>,KeyType,ValueType>(trace,"",requests,loaded));
+    cases.emplace_back(new BenchmarkReplayCase<std::map<KeyType,ValueType>,KeyType,ValueType>(trace,"",requests,loaded));
+    return true;
+}
+
+// integers of any width are replayed with the 64-bit type of the same signedness, their encoding does not depend on the width
+template<typename Type>
+inline bool BenchmarkReplayAccepts(RBTreeArrayRecordKind kind,uint64_t byteSize){
+    if(kind!=RBTreeArrayRecordCodec<Type>::kind){
+        return false;
+    }
+    return kind==RBTreeArrayRecordKind::String||byteSize<=sizeof(Type);
+}
+
+template<typename KeyType>
+bool BenchmarkRegisterReplayValue(std::vector<std::unique_ptr<BenchmarkCase>>& cases,const std::shared_ptr<const std::vector<char>>& trace,const RBTreeArrayRecordReader& reader){
+    if(BenchmarkReplayAccepts<uint64_t>(reader.ValueKind(),reader.ValueByteSize())){
+        return BenchmarkRegisterReplay<KeyType,uint64_t>(cases,trace);
+    }
+    if(BenchmarkReplayAccepts<int64_t>(reader.ValueKind(),reader.ValueByteSize())){
+        return BenchmarkRegisterReplay<KeyType,int64_t>(cases,trace);
+    }
+    if(BenchmarkReplayAccepts<std::string>(reader.ValueKind(),reader.ValueByteSize())){
+        return BenchmarkRegisterReplay<KeyType,std::string>(cases,trace);
+    }
+    return false;
+}
+
+bool BenchmarkRegisterReplay(std::vector<std::unique_ptr<BenchmarkCase>>& cases,const std::string& path){
+    FILE* file=fopen(path.c_str(),"rb");
+    if(!file){
+        fprintf(stderr,"can not open %s\n",path.c_str());
+        return false;
+    }
+    std::shared_ptr<std::vector<char>> trace(new std::vector<char>());
+    char buffer[1<<16];
+    size_t readed;
+    while((readed=fread(buffer,1,sizeof(buffer),file))>0){
+        trace->insert(trace->end(),buffer,buffer+readed);
+    }
+    fclose(file);
+    RBTreeArrayRecordReader reader(trace->data(),trace->size());
+    if(!reader.Valid()){
+        fprintf(stderr,"%s is not a RBTreeArrayRecorder trace\n",path.c_str());
+        return false;
+    }
+    bool registered=false;
+    if(BenchmarkReplayAccepts<uint64_t>(reader.KeyKind(),reader.KeyByteSize())){
+        registered=BenchmarkRegisterReplayValue<uint64_t>(cases,trace,reader);
+    }
+    else if(BenchmarkReplayAccepts<int64_t>(reader.KeyKind(),reader.KeyByteSize())){
+        registered=BenchmarkRegisterReplayValue<int64_t>(cases,trace,reader);
+    }
+    else if(BenchmarkReplayAccepts<std::string>(reader.KeyKind(),reader.KeyByteSize())){
+        registered=BenchmarkRegisterReplayValue<std::string>(cases,trace,reader);
+    }
+    if(!registered){
+        fprintf(stderr,"%s: no requests, or key kind %d (%llu bytes) / value kind %d (%llu bytes) not handled by BenchmarkRegisterReplay\n",path.c_str(),
+            int(reader.KeyKind()),(long long unsigned int)reader.KeyByteSize(),int(reader.ValueKind()),(long long unsigned int)reader.ValueByteSize());
+    }
+    return registered;
+}
+
+// keys kept in one sorted array, batches are appended, sorted and merged in
+template<typename KeyType,typename ValueType>
+struct BenchmarkSortedVector{
+    std::vector<std::pair<KeyType,ValueType>> pairs;
+};
+
+template<typename KeyType,typename ValueType>
+struct BenchmarkTree<std::unordered_map<KeyType,ValueType>>{
+    static std::string Name(){
+        return std::string("std::unordered_map<")+BenchmarkType<KeyType>::Name()+","+BenchmarkType<ValueType>::Name()+">";
+    }
+};
+
+template<typename KeyType,typename ValueType>
+struct BenchmarkTree<BenchmarkSortedVector<KeyType,ValueType>>{
+    static std::string Name(){
+        return std::string("sorted std::vector<")+BenchmarkType<KeyType>::Name()+","+BenchmarkType<ValueType>::Name()+">";
+    }
+};
+
+struct BenchmarkMemoryResult{
+    std::string name;
+    std::string treeName;
+    uint64_t size;
+    double bytesPerEntry;        // after inserting size keys
+    double peakBytesPerEntry;    // highest during those inserts
+    double peakToSteady;
+    double allocationsPerEntry;
+    double deletedBytesPerEntry; // after deleting half of the keys, per remaining key
+    double churnBytesPerEntry;   // after four rounds of inserting and deleting half the keys, back to the same keys
+    double freshBytesPerEntry;   // a new store configured like the measured one holding the same keys
+    double fragmentation;        // 1-fresh/churn
+    int64_t leakedBytes;         // still counted after the stores are destroyed, should be 0
+};
+
+template<typename TreeType,typename KeyType,typename ValueType>
+inline void BenchmarkMemoryInsert(TreeType& tree,const std::vector<KeyType>& keys,const std::vector<ValueType>& values,uint64_t begin,uint64_t end){
+    for(uint64_t index=begin;index<end;index=index+1){
+        tree.Insert(keys[index],values[index]);
+    }
+}
+
+template<typename TreeType,typename KeyType>
+inline void BenchmarkMemoryDelete(TreeType& tree,const std::vector<KeyType>& keys,uint64_t begin,uint64_t end){
+    for(uint64_t index=begin;index<end;index=index+1){
+        tree.Delete(keys[index]);
+    }
+}
+
+template<typename TreeType>
+inline void BenchmarkMemoryConfigure(TreeType& tree,const std::string& mode){
+    if(mode=="incremental"){
+        tree.SetIncrementalGrowth(64);
+    }
+}
+
+template<typename TreeType>
+inline void BenchmarkMemoryShrink(TreeType& tree,const std::string& mode){
+    if(mode=="shrink"){
+        tree.MemoryShrink();
+    }
+}
+
+template<typename KeyType,typename ValueType>
+inline void BenchmarkMemoryInsert(std::map<KeyType,ValueType>& map,const std::vector<KeyType>& keys,const std::vector<ValueType>& values,uint64_t begin,uint64_t end){
+    for(uint64_t index=begin;index<end;index=index+1){
+        map.insert_or_assign(keys[index],values[index]);
+    }
+}
+
+template<typename KeyType,typename ValueType>
+inline void BenchmarkMemoryDelete(std::map<KeyType,ValueType>& map,const std::vector<KeyType>& keys,uint64_t begin,uint64_t end){
+    for(uint64_t index=begin;index<end;index=index+1){
+        map.erase(keys[index]);
+    }
+}
+
+template<typename KeyType,typename ValueType>
+inline void BenchmarkMemoryConfigure(std::map<KeyType,ValueType>& map,const std::string& mode){
+}
+
+template<typename KeyType,typename ValueType>
+inline void BenchmarkMemoryShrink(std::map<KeyType,ValueType>& map,const std::string& mode){
+}
+
+template<typename KeyType,typename ValueType>
+inline void BenchmarkMemoryInsert(std::unordered_map<KeyType,ValueType>& map,const std::vector<KeyType>& keys,const std::vector<ValueType>& values,uint64_t begin,uint64_t end){
+    for(uint64_t index=begin;index<end;index=index+1){
+        map.insert_or_assign(keys[index],values[index]);
+    }
+}
+
+template<typename KeyType,typename ValueType>
+inline void BenchmarkMemoryDelete(std::unordered_map<KeyType,ValueType>& map,const std::vector<KeyType>& keys,uint64_t begin,uint64_t end){
+    for(uint64_t index=begin;index<end;index=index+1){
+        map.erase(keys[index]);
+    }
+}
+
+template<typename KeyType,typename ValueType>
+inline void BenchmarkMemoryConfigure(std::unordered_map<KeyType,ValueType>& map,const std::string& mode){
+}
+
+template<typename KeyType,typename ValueType>
+inline void BenchmarkMemoryShrink(std::unordered_map<KeyType,ValueType>& map,const std::string& mode){
+}
+
+// the keys of a batch are distinct and not in the vector yet
+template<typename KeyType,typename ValueType>
+inline void BenchmarkMemoryInsert(BenchmarkSortedVector<KeyType,ValueType>& vector,const std::vector<KeyType>& keys,const std::vector<ValueType>& values,uint64_t begin,uint64_t end){
+    const size_t oldSize=vector.pairs.size();
+    for(uint64_t index=begin;index<end;index=index+1){
+        vector.pairs.emplace_back(keys[index],values[index]);
+    }
+    auto less=[](const std::pair<KeyType,ValueType>& left,const std::pair<KeyType,ValueType>& right){return left.first<right.first;};
+    std::sort(vector.pairs.begin()+oldSize,vector.pairs.end(),less);
+    std::inplace_merge(vector.pairs.begin(),vector.pairs.begin()+oldSize,vector.pairs.end(),less);
+}
+
+template<typename KeyType,typename ValueType>
+inline void BenchmarkMemoryDelete(BenchmarkSortedVector<KeyType,ValueType>& vector,const std::vector<KeyType>& keys,uint64_t begin,uint64_t end){
+    std::vector<KeyType> sortedKeys(keys.begin()+begin,keys.begin()+end);
+    std::sort(sortedKeys.begin(),sortedKeys.end());
+    vector.pairs.erase(std::remove_if(vector.pairs.begin(),vector.pairs.end(),[&](const std::pair<KeyType,ValueType>& pair){
+        return std::binary_search(sortedKeys.begin(),sortedKeys.end(),pair.first);
+    }),vector.pairs.end());
+}
+
+template<typename KeyType,typename ValueType>
+inline void BenchmarkMemoryConfigure(BenchmarkSortedVector<KeyType,ValueType>& vector,const std::string& mode){
+}
+
+template<typename KeyType,typename ValueType>
+inline void BenchmarkMemoryShrink(BenchmarkSortedVector<KeyType,ValueType>& vector,const std::string& mode){
+    if(mode=="shrink"){
+        vector.pairs.shrink_to_fit();
+    }
+}
+
+class BenchmarkMemoryCase{
+public:
+    std::string name;
+    std::string treeName;
+    uint64_t size=0;
+
+    virtual ~BenchmarkMemoryCase(){}
+    virtual BenchmarkMemoryResult Measure()=0;
+};
+
+// mode: "" as constructed, "incremental" SetIncrementalGrowth(64), "shrink" MemoryShrink() after every delete batch
+template<typename StoreType,typename KeyType,typename ValueType>
+class BenchmarkMemory:public BenchmarkMemoryCase{
+    uint64_t seed;
+    std::string mode;
+public:
+    BenchmarkMemory(const std::string& caseMode,uint64_t caseSize,uint64_t caseSeed){
+        mode=caseMode;
+        name=mode.empty()?"memory":"memory_"+mode;
+        treeName=BenchmarkTree<StoreType>::Name();
+        size=caseSize;
+        seed=caseSeed;
+    }
+    BenchmarkMemoryResult Measure()override{
+        BenchmarkData<KeyType,ValueType> data(size,seed);
+        BenchmarkAllocationCounter& counter=BenchmarkAllocations();
+        BenchmarkMemoryResult result{};
+        result.name=name;
+        result.treeName=treeName;
+        result.size=size;
+        const uint64_t half=size/2;
+        const double remaining=double(std::max<uint64_t>(size-half,1));
+        counter.Reset();
+        {
+            StoreType store;
+            BenchmarkMemoryConfigure(store,mode);
+            BenchmarkMemoryInsert(store,data.keys,data.values,0,size);
+            const double steady=double(counter.bytes.load());
+            result.bytesPerEntry=steady/size;
+            result.peakBytesPerEntry=double(counter.peak.load())/size;
+            result.peakToSteady=steady>0?counter.peak.load()/steady:0;
+            result.allocationsPerEntry=double(counter.allocations.load())/size;
+            BenchmarkMemoryDelete(store,data.keys,0,half);
+            BenchmarkMemoryShrink(store,mode);
+            result.deletedBytesPerEntry=counter.bytes.load()/remaining;
+            // every round grows back to about size keys, the last one ends on the keys left by the delete above
+            BenchmarkMemoryInsert(store,data.probes,data.values,0,half);
+            BenchmarkMemoryDelete(store,data.keys,half,size);
+            BenchmarkMemoryShrink(store,mode);
+            BenchmarkMemoryInsert(store,data.keys,data.values,0,half);
+            BenchmarkMemoryDelete(store,data.probes,0,half);
+            BenchmarkMemoryShrink(store,mode);
+            BenchmarkMemoryInsert(store,data.probes,data.values,half,size);
+            BenchmarkMemoryDelete(store,data.keys,0,half);
+            BenchmarkMemoryShrink(store,mode);
+            BenchmarkMemoryInsert(store,data.keys,data.values,half,size);
+            BenchmarkMemoryDelete(store,data.probes,half,size);
+            BenchmarkMemoryShrink(store,mode);
+            const double churn=double(counter.bytes.load());
+            result.churnBytesPerEntry=churn/remaining;
+            {
+                StoreType fresh;
+                BenchmarkMemoryConfigure(fresh,mode);
+                BenchmarkMemoryInsert(fresh,data.keys,data.values,half,size);
+                BenchmarkMemoryShrink(fresh,mode);
+                result.freshBytesPerEntry=(counter.bytes.load()-churn)/remaining;
+            }
+            result.fragmentation=churn>0?1-result.freshBytesPerEntry*remaining/churn:0;
+        }
+        result.leakedBytes=counter.bytes.load();
+        counter.Stop();
+        return result;
+    }
+};
+
+template<typename KeyType,typename ValueType>
+void BenchmarkRegisterMemory(std::vector<std::unique_ptr<BenchmarkMemoryCase>>& cases,uint64_t size,uint64_t seed){
+    // RBTreeArray16 holds at most 65535 nodes
+    cases.emplace_back(new BenchmarkMemory<RBTreeArray16<KeyType,ValueType>,KeyType,ValueType>("",std::min<uint64_t>(size,60000),seed));
+    cases.emplace_back(new BenchmarkMemory<RBTreeArray32<KeyType,ValueType>,KeyType,ValueType>("",size,seed));
+    cases.emplace_back(new BenchmarkMemory<RBTreeArray32<KeyType,ValueType>,KeyType,ValueType>("incremental",size,seed));
+    cases.emplace_back(new BenchmarkMemory<RBTreeArray32<KeyType,ValueType>,KeyType,ValueType>("shrink",size,seed));
+    cases.emplace_back(new BenchmarkMemory<RBTreeArray64<KeyType,ValueType>,KeyType,ValueType>("",size,seed));
+    cases.emplace_back(new BenchmarkMemory<std::map<KeyType,ValueType>,KeyType,ValueType>("",size,seed));
+    cases.emplace_back(new BenchmarkMemory<std::unordered_map<KeyType,ValueType>,KeyType,ValueType>("",size,seed));
+    cases.emplace_back(new BenchmarkMemory<BenchmarkSortedVector<KeyType,ValueType>,KeyType,ValueType>("",size,seed));
+    cases.emplace_back(new BenchmarkMemory<BenchmarkSortedVector<KeyType,ValueType>,KeyType,ValueType>("shrink",size,seed));
+}
+
+std::vector<std::unique_ptr<BenchmarkMemoryCase>> BenchmarkMemoryCases(const BenchmarkOptions& options){
+    std::vector<std::unique_ptr<BenchmarkMemoryCase>> cases;
+    BenchmarkRegisterMemory<uint32_t,uint32_t>(cases,options.size,options.seed);
+    BenchmarkRegisterMemory<uint64_t,uint64_t>(cases,options.size,options.seed);
+    BenchmarkRegisterMemory<std::string,uint64_t>(cases,options.size,options.seed);
+    return cases;
+}
+
+std::vector<std::unique_ptr<BenchmarkCase>> BenchmarkCases(const BenchmarkOptions& options){
+    std::vector<std::unique_ptr<BenchmarkCase>> cases;
+    if(!options.replay.empty()){
+        BenchmarkRegisterReplay(cases,options.replay);
+        return cases;
+    }
+    // RBTreeArray16 holds at most 65535 nodes
+    const uint64_t size16=std::min<uint64_t>(options.size,60000);
+    BenchmarkRegister<RBTreeArray16<uint32_t,uint32_t>,uint32_t,uint32_t>(cases,size16,options.seed);
+    BenchmarkRegister<RBTreeArray16<uint64_t,uint64_t>,uint64_t,uint64_t>(cases,size16,options.seed);
+    BenchmarkRegister<RBTreeArray16<std::string,uint64_t>,std::string,uint64_t>(cases,size16,options.seed);
+    BenchmarkRegister<RBTreeArray32<uint32_t,uint32_t>,uint32_t,uint32_t>(cases,options.size,options.seed);
+    BenchmarkRegister<RBTreeArray32<uint64_t,uint64_t>,uint64_t,uint64_t>(cases,options.size,options.seed);
+    BenchmarkRegister<RBTreeArray32<std::string,uint64_t>,std::string,uint64_t>(cases,options.size,options.seed);
+    BenchmarkRegister<RBTreeArray64<uint32_t,uint32_t>,uint32_t,uint32_t>(cases,options.size,options.seed);
+    BenchmarkRegister<RBTreeArray64<uint64_t,uint64_t>,uint64_t,uint64_t>(cases,options.size,options.seed);
+    BenchmarkRegister<RBTreeArray64<std::string,uint64_t>,std::string,uint64_t>(cases,options.size,options.seed);
+    // requests insert at most one record each, records+operations stays inside RBTreeArray16
+    const uint64_t records16=std::min<uint64_t>(options.size,30000);
+    for(const BenchmarkWorkload& workload:BenchmarkWorkloads(options)){
+        cases.emplace_back(new BenchmarkWorkloadCase<RBTreeArray16<uint64_t,uint64_t>>(workload,records16,options.seed));
+        cases.emplace_back(new BenchmarkWorkloadCase<RBTreeArray32<uint64_t,uint64_t>>(workload,options.size,options.seed));
+        cases.emplace_back(new BenchmarkWorkloadCase<RBTreeArray64<uint64_t,uint64_t>>(workload,options.size,options.seed));
+        cases.emplace_back(new BenchmarkWorkloadCase<std::map<uint64_t,uint64_t>>(workload,options.size,options.seed));
+    }
+    // both lists were checked by BenchmarkParseOptions
+    std::vector<int> cpus;
+    if(options.threadCPUs.empty()){
+        cpus=BenchmarkAllowedCPUs();
+    }
+    else{
+        BenchmarkParseList(options.threadCPUs,cpus);
+    }
+    std::vector<int> threadCounts;
+    if(options.threads.empty()){
+        for(int threads=1;threads<int(cpus.size());threads=threads*2){
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(int(cpus.size()));
+    }
+    else{
+        BenchmarkParseList(options.threads,threadCounts);
+    }
+    BenchmarkRegisterConcurrent<RBTreeArray32<uint64_t,uint64_t>,uint64_t,uint64_t>(cases,options.size,options.seed,threadCounts,cpus);
+    BenchmarkRegisterConcurrent<RBTreeArray64<uint64_t,uint64_t>,uint64_t,uint64_t>(cases,options.size,options.seed,threadCounts,cpus);
+    BenchmarkRegisterConcurrent<RBTreeArray32<std::string,uint64_t>,std::string,uint64_t>(cases,options.size,options.seed,threadCounts,cpus);
+    return cases;
+}
+
+inline double BenchmarkPercentile(const std::vector<double>& sorted,double percentile){
+    if(sorted.empty()){
+        return 0;
+    }
+    uint64_t index=uint64_t(percentile*(sorted.size()-1)+0.5);
+    return sorted[index];
+}
+
+BenchmarkResult BenchmarkRun(BenchmarkCase& benchmark,const BenchmarkOptions& options,double clockOverhead,BenchmarkCounters* counters){
+    BenchmarkResult result;
+    result.name=benchmark.name;
+    result.treeName=benchmark.treeName;
+    result.size=benchmark.size;
+    result.operations=benchmark.operations;
+    result.repetitions=options.repetitions;
+    result.latency=benchmark.latency;
+    result.p50=result.p90=result.p99=result.p999=result.max=0;
+    result.counters=counters!=nullptr;
+    double counterTotals[BenchmarkCounterCount]={0};
+
+    benchmark.Prepare();
+    for(uint64_t index=0;index<options.warmup;index=index+1){
+        benchmark.Setup();
+        benchmark.Run(0,benchmark.operations);
+    }
+
+    std::vector<double> perOperation;
+    for(uint64_t index=0;index<options.repetitions;index=index+1){
+        benchmark.Setup();
+        if(counters){
+            counters->Start();
+        }
+        uint64_t start=BenchmarkNow();
+        benchmark.Run(0,benchmark.operations);
+        uint64_t end=BenchmarkNow();
+        if(counters){
+            counters->Stop();
+            counters->Accumulate(counterTotals);
+        }
+        perOperation.push_back(double(end-start)/benchmark.operations);
+    }
+    for(unsigned index=0;index<BenchmarkCounterCount;index=index+1){
+        if(counters&&counters->Available(index)){
+            result.counterPerOperation[index]=counterTotals[index]/(double(benchmark.operations)*options.repetitions);
+        }
+        else{
+            result.counterPerOperation[index]=-1;
+        }
+    }
+    std::vector<double> sorted=perOperation;
+    std::sort(sorted.begin(),sorted.end());
+    double mean=0;
+    for(double value:perOperation){
+        mean=mean+value;
+    }
+    mean=mean/perOperation.size();
+    double variance=0;
+    for(double value:perOperation){
+        variance=variance+(value-mean)*(value-mean);
+    }
+    result.nsPerOperation=sorted[sorted.size()/2];
+    result.nsPerOperationMin=sorted.front();
+    result.nsPerOperationStddev=perOperation.size()>1?std::sqrt(variance/(perOperation.size()-1)):0;
+    result.operationsPerSecond=result.nsPerOperation>0?1e9/result.nsPerOperation:0;
+    result.samples=perOperation;
+
+    if(benchmark.latency){
+        std::vector<double> samples;
+        benchmark.Setup();
+        benchmark.Latency(samples,clockOverhead);
+        std::sort(samples.begin(),samples.end());
+        result.p50=BenchmarkPercentile(samples,0.50);
+        result.p90=BenchmarkPercentile(samples,0.90);
+        result.p99=BenchmarkPercentile(samples,0.99);
+        result.p999=BenchmarkPercentile(samples,0.999);
+        result.max=samples.back();
+    }
+    benchmark.Release();
+    return result;
+}
+
+void BenchmarkPrintHeader(FILE* file,const BenchmarkOptions& options){
+    if(options.format=="csv"){
+        fprintf(file,"name,tree,size,operations,repetitions,ns_per_op,ns_per_op_min,ns_per_op_stddev,ops_per_second,p50_ns,p90_ns,p99_ns,p999_ns,max_ns");
+        if(options.counters){
+            for(unsigned index=0;index<BenchmarkCounterCount;index=index+1){
+                fprintf(file,",%s_per_op",BenchmarkCounterName(index));
+            }
+        }
+        fprintf(file,"\n");
+    }
+    else if(options.format=="json"){
+        fprintf(file,"[\n");
+    }
+    else{
+        fprintf(file,"%-22s %-36s %9s %10s %10s %8s %14s %9s %9s %9s %9s %10s","name","tree","size","ns/op","min","stddev","ops/s","p50","p90","p99","p99.9","max");
+        if(options.counters){
+            fprintf(file," %9s %9s %9s %9s %9s %9s","cycles/op","instr/op","L1D/op","LLC/op","branch/op","dTLB/op");
+        }
+        fprintf(file,"\n");
+    }
+}
+
+void BenchmarkPrintResult(FILE* file,const BenchmarkOptions& options,const BenchmarkResult& result,bool first){
+    if(options.format=="csv"){
+        fprintf(file,"%s,\"%s\",%llu,%llu,%llu,%.3f,%.3f,%.3f,%.1f,",result.name.c_str(),result.treeName.c_str(),(long long unsigned int)result.size,(long long unsigned int)result.operations,(long long unsigned int)result.repetitions,result.nsPerOperation,result.nsPerOperationMin,result.nsPerOperationStddev,result.operationsPerSecond);
+        if(result.latency){
+            fprintf(file,"%.1f,%.1f,%.1f,%.1f,%.1f",result.p50,result.p90,result.p99,result.p999,result.max);
+        }
+        else{
+            fprintf(file,",,,,");
+        }
+        if(result.counters){
+            for(unsigned index=0;index<BenchmarkCounterCount;index=index+1){
+                if(result.counterPerOperation[index]>=0){
+                    fprintf(file,",%.3f",result.counterPerOperation[index]);
+                }
+                else{
+                    fprintf(file,",");
+                }
+            }
+        }
+        fprintf(file,"\n");
+    }
+    else if(options.format=="json"){
+        fprintf(file,"%s  {\"name\": \"%s\", \"tree\": \"%s\", \"size\": %llu, \"operations\": %llu, \"repetitions\": %llu, \"ns_per_op\": %.3f, \"ns_per_op_min\": %.3f, \"ns_per_op_stddev\": %.3f, \"ops_per_second\": %.1f",first?"":",\n",result.name.c_str(),result.treeName.c_str(),(long long unsigned int)result.size,(long long unsigned int)result.operations,(long long unsigned int)result.repetitions,result.nsPerOperation,result.nsPerOperationMin,result.nsPerOperationStddev,result.operationsPerSecond);
+        fprintf(file,", \"samples_ns_per_op\": [");
+        for(uint64_t index=0;index<result.samples.size();index=index+1){
+            fprintf(file,"%s%.3f",index==0?"":", ",result.samples[index]);
+        }
+        fprintf(file,"]");
+        if(result.latency){
+            fprintf(file,", \"p50_ns\": %.1f, \"p90_ns\": %.1f, \"p99_ns\": %.1f, \"p999_ns\": %.1f, \"max_ns\": %.1f",result.p50,result.p90,result.p99,result.p999,result.max);
+        }
+        if(result.counters){
+            for(unsigned index=0;index<BenchmarkCounterCount;index=index+1){
+                if(result.counterPerOperation[index]>=0){
+                    fprintf(file,", \"%s_per_op\": %.3f",BenchmarkCounterName(index),result.counterPerOperation[index]);
+                }
+            }
+        }
+        fprintf(file,"}");
+    }
+    else{
+        fprintf(file,"%-22s %-36s %9llu %10.2f %10.2f %8.2f %14.0f",result.name.c_str(),result.treeName.c_str(),(long long unsigned int)result.size,result.nsPerOperation,result.nsPerOperationMin,result.nsPerOperationStddev,result.operationsPerSecond);
+        if(result.latency){
+            fprintf(file," %9.0f %9.0f %9.0f %9.0f %10.0f",result.p50,result.p90,result.p99,result.p999,result.max);
+        }
+        else{
+            fprintf(file," %9s %9s %9s %9s %10s","-","-","-","-","-");
+        }
+        if(result.counters){
+            for(unsigned index=0;index<BenchmarkCounterCount;index=index+1){
+                if(result.counterPerOperation[index]>=0){
+                    fprintf(file," %9.2f",result.counterPerOperation[index]);
+                }
+                else{
+                    fprintf(file," %9s","-");
+                }
+            }
+        }
+        fprintf(file,"\n");
+    }
+    fflush(file);
+}
+
+void BenchmarkPrintMemoryHeader(FILE* file,const BenchmarkOptions& options){
+    if(options.format=="csv"){
+        fprintf(file,"name,tree,size,bytes_per_entry,peak_bytes_per_entry,peak_to_steady,allocations_per_entry,deleted_bytes_per_entry,churn_bytes_per_entry,fresh_bytes_per_entry,fragmentation\n");
+    }
+    else if(options.format=="json"){
+        fprintf(file,"[\n");
+    }
+    else{
+        fprintf(file,"%-22s %-44s %9s %9s %9s %9s %9s %9s %9s %9s %7s\n","name","tree","size","B/entry","peak B/e","peak/std","allocs/e","del B/e","churn B/e","fresh B/e","frag");
+    }
+}
+
+void BenchmarkPrintMemoryResult(FILE* file,const BenchmarkOptions& options,const BenchmarkMemoryResult& result,bool first){
+    if(options.format=="csv"){
+        fprintf(file,"%s,\"%s\",%llu,%.2f,%.2f,%.3f,%.3f,%.2f,%.2f,%.2f,%.4f\n",result.name.c_str(),result.treeName.c_str(),(long long unsigned int)result.size,
+            result.bytesPerEntry,result.peakBytesPerEntry,result.peakToSteady,result.allocationsPerEntry,result.deletedBytesPerEntry,result.churnBytesPerEntry,result.freshBytesPerEntry,result.fragmentation);
+    }
+    else if(options.format=="json"){
+        fprintf(file,"%s  {\"name\": \"%s\", \"tree\": \"%s\", \"size\": %llu, \"bytes_per_entry\": %.2f, \"peak_bytes_per_entry\": %.2f, \"peak_to_steady\": %.3f, \"allocations_per_entry\": %.3f, \"deleted_bytes_per_entry\": %.2f, \"churn_bytes_per_entry\": %.2f, \"fresh_bytes_per_entry\": %.2f, \"fragmentation\": %.4f}",
+            first?"":",\n",result.name.c_str(),result.treeName.c_str(),(long long unsigned int)result.size,
+            result.bytesPerEntry,result.peakBytesPerEntry,result.peakToSteady,result.allocationsPerEntry,result.deletedBytesPerEntry,result.churnBytesPerEntry,result.freshBytesPerEntry,result.fragmentation);
+    }
+    else{
+        fprintf(file,"%-22s %-44s %9llu %9.2f %9.2f %9.3f %9.3f %9.2f %9.2f %9.2f %7.3f\n",result.name.c_str(),result.treeName.c_str(),(long long unsigned int)result.size,
+            result.bytesPerEntry,result.peakBytesPerEntry,result.peakToSteady,result.allocationsPerEntry,result.deletedBytesPerEntry,result.churnBytesPerEntry,result.freshBytesPerEntry,result.fragmentation);
+    }
+    if(result.leakedBytes!=0){
+        fprintf(stderr,"warning: %s %s left %lld bytes allocated\n",result.name.c_str(),result.treeName.c_str(),(long long int)result.leakedBytes);
+    }
+    fflush(file);
+}
+
+void BenchmarkPrintFooter(FILE* file,const BenchmarkOptions& options){
+    if(options.format=="json"){
+        fprintf(file,"\n]\n");
+    }
+}
+
+void BenchmarkUsage(const char* program){
+    fprintf(stderr,"usage: %s [--size N] [--warmup N] [--repetitions N] [--seed N] [--cpu N] [--filter TEXT] [--format table|csv|json] [--output FILE] [--distribution uniform|zipfian|hotspot|latest|sequential] [--mix read=N,update=N,insert=N,scan=N,rmw=N,delete=N] [--counters] [--threads LIST] [--thread-cpus LIST] [--numa-memory local|interleave|NODE] [--replay FILE] [--memory] [--list]\n",program);
+}
+
+bool BenchmarkParseOptions(int argc,char** argv,BenchmarkOptions& options){
+    for(int index=1;index<argc;index=index+1){
+        std::string argument=argv[index];
+        if(argument=="--list"){
+            options.list=true;
+            continue;
+        }
+        if(argument=="--counters"){
+            options.counters=true;
+            continue;
+        }
+        if(argument=="--memory"){
+            options.memory=true;
+            continue;
+        }
+        if(argument=="--help"||argument=="-h"||index+1>=argc){
+            return false;
+        }
+        std::string value=argv[index+1];
+        index=index+1;
+        if(argument=="--size"){
+            options.size=strtoull(value.c_str(),nullptr,10);
+        }
+        else if(argument=="--warmup"){
+            options.warmup=strtoull(value.c_str(),nullptr,10);
+        }
+        else if(argument=="--repetitions"){
+            options.repetitions=strtoull(value.c_str(),nullptr,10);
+        }
+        else if(argument=="--seed"){
+            options.seed=strtoull(value.c_str(),nullptr,10);
+        }
+        else if(argument=="--cpu"){
+            options.cpu=atoi(value.c_str());
+        }
+        else if(argument=="--filter"){
+            options.filter=value;
+        }
+        else if(argument=="--format"){
+            if(value!="table"&&value!="csv"&&value!="json"){
+                return false;
+            }
+            options.format=value;
+        }
+        else if(argument=="--output"){
+            options.output=value;
+        }
+        else if(argument=="--distribution"){
+            BenchmarkDistribution distribution;
+            if(!BenchmarkParseDistribution(value,distribution)){
+                return false;
+            }
+            options.distribution=value;
+        }
+        else if(argument=="--threads"){
+            std::vector<int> list;
+            if(!BenchmarkParseList(value,list)||std::find(list.begin(),list.end(),0)!=list.end()){
+                return false;
+            }
+            options.threads=value;
+        }
+        else if(argument=="--thread-cpus"){
+            std::vector<int> list;
+            if(!BenchmarkParseList(value,list)){
+                return false;
+            }
+            options.threadCPUs=value;
+        }
+        else if(argument=="--replay"){
+            options.replay=value;
+        }
+        else if(argument=="--numa-memory"){
+            options.numaMemory=value;
+        }
+        else if(argument=="--mix"){
+            BenchmarkWorkload workload;
+            if(!BenchmarkParseMix(value,workload)){
+                return false;
+            }
+            options.mix=value;
+        }
+        else{
+            return false;
+        }
+    }
+    return options.size>0&&options.repetitions>0;
+}
+
+int BenchmarkMemoryMain(const BenchmarkOptions& options){
+    std::vector<std::unique_ptr<BenchmarkMemoryCase>> cases=BenchmarkMemoryCases(options);
+    std::vector<BenchmarkMemoryCase*> selected;
+    for(auto& benchmark:cases){
+        std::string fullName=benchmark->name+" "+benchmark->treeName;
+        if(options.filter.empty()||fullName.find(options.filter)!=std::string::npos){
+            selected.push_back(benchmark.get());
+        }
+    }
+    if(options.list){
+        for(BenchmarkMemoryCase* benchmark:selected){
+            printf("%s %s\n",benchmark->name.c_str(),benchmark->treeName.c_str());
+        }
+        return 0;
+    }
+    if(!BenchmarkAllocationCounter::Available()){
+        fprintf(stderr,"--memory needs malloc_usable_size, only available on Linux\n");
+        return 1;
+    }
+    FILE* file=stdout;
+    if(!options.output.empty()){
+        file=fopen(options.output.c_str(),"w");
+        if(!file){
+            fprintf(stderr,"can not open %s\n",options.output.c_str());
+            return 1;
+        }
+    }
+    BenchmarkPrintMemoryHeader(file,options);
+    for(uint64_t index=0;index<selected.size();index=index+1){
+        BenchmarkMemoryResult result=selected[index]->Measure();
+        BenchmarkPrintMemoryResult(file,options,result,index==0);
+    }
+    BenchmarkPrintFooter(file,options);
+    if(file!=stdout){
+        fclose(file);
+    }
+    return 0;
+}
+
+int main(int argc,char** argv){
+    BenchmarkOptions options;
+    if(!BenchmarkParseOptions(argc,argv,options)){
+        BenchmarkUsage(argv[0]);
+        return 1;
+    }
+    if(options.memory){
+        return BenchmarkMemoryMain(options);
+    }
+    std::vector<std::unique_ptr<BenchmarkCase>> cases=BenchmarkCases(options);
+    std::vector<BenchmarkCase*> selected;
+    for(auto& benchmark:cases){
+        std::string fullName=benchmark->name+" "+benchmark->treeName;
+        if(options.filter.empty()||fullName.find(options.filter)!=std::string::npos){
+            selected.push_back(benchmark.get());
+        }
+    }
+    if(options.list){
+        for(BenchmarkCase* benchmark:selected){
+            printf("%s %s\n",benchmark->name.c_str(),benchmark->treeName.c_str());
+        }
+        return 0;
+    }
+    if(options.cpu>=0&&!BenchmarkPinToCPU(options.cpu)){
+        fprintf(stderr,"warning: can not pin to cpu %d\n",options.cpu);
+    }
+    if(!BenchmarkSetMemoryPolicy(options.numaMemory)){
+        fprintf(stderr,"warning: can not set memory policy %s\n",options.numaMemory.c_str());
+    }
+    FILE* file=stdout;
+    if(!options.output.empty()){
+        file=fopen(options.output.c_str(),"w");
+        if(!file){
+            fprintf(stderr,"can not open %s\n",options.output.c_str());
+            return 1;
+        }
+    }
+    double clockOverhead=BenchmarkClockOverhead();
+    std::unique_ptr<BenchmarkCounters> counters;
+    if(options.counters){
+        counters.reset(new BenchmarkCounters());
+        if(!counters->AnyAvailable()){
+            fprintf(stderr,"warning: no hardware counter available, check /proc/sys/kernel/perf_event_paranoid\n");
+        }
+    }
+    fprintf(stderr,"clock overhead: %.1f ns, %zu cases\n",clockOverhead,selected.size());
+    BenchmarkPrintHeader(file,options);
+    for(uint64_t index=0;index<selected.size();index=index+1){
+        BenchmarkResult result=BenchmarkRun(*selected[index],options,clockOverhead,counters.get());
+        BenchmarkPrintResult(file,options,result,index==0);
+    }
+    BenchmarkPrintFooter(file,options);
+    if(file!=stdout){
+        fclose(file);
+    }
+    return 0;
+}
@@ -0,0 +1,451 @@
+// Regression check between two runs of benchmark.cpp
+//
+// Build: g++ -std=c++17 -O2 benchmark_compare.cpp -o benchmark_compare
+// Run:   ./benchmark --format json --repetitions 15 --output old.json   (with the old header)
+//        ./benchmark --format json --repetitions 15 --output new.json   (with the new header)
+//        ./benchmark_compare old.json new.json [--threshold PERCENT] [--alpha P] [--confidence C] [--bootstrap N] [--seed N] [--filter TEXT]
+//
+// Cases are matched by name and tree. For every pair the samples_ns_per_op of the timed repetitions are compared
+// with a one-sided Mann-Whitney U test (exact distribution up to 25 samples per side without ties, normal
+// approximation with tie correction otherwise), and a bootstrap percentile interval of new median / old median
+// is drawn from --bootstrap resamples. A case is a regression when new is slower with p < --alpha (default 0.05)
+// and its median is more than --threshold percent (default 5) slower, an improvement the other way round.
+//
+// Exit status: 0 without regressions, 1 with at least one, 2 when an input can not be read.
+// More repetitions give the test more power, 5 per side can not go below p=0.004.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "PCG32.h"
+
+// only what benchmark.cpp writes: objects, arrays, strings, numbers, true/false/null
+struct CompareJsonValue{
+    enum Type{Null,Boolean,Number,String,Array,Object} type=Null;
+    double number=0;
+    std::string text;
+    std::vector<CompareJsonValue> items;
+    std::vector<std::pair<std::string,CompareJsonValue>> members;
+
+    const CompareJsonValue* Member(const char* name)const{
+        for(const auto& member:members){
+            if(member.first==name){
+                return &member.second;
+            }
+        }
+        return nullptr;
+    }
+};
+
+class CompareJsonParser{
+    const std::string& text;
+    size_t position=0;
+
+    void SkipSpace(){
+        while(position<text.size()&&(text[position]==' '||text[position]=='\n'||text[position]=='\r'||text[position]=='\t')){
+            position=position+1;
+        }
+    }
+    bool Expect(char character){
+        SkipSpace();
+        if(position<text.size()&&text[position]==character){
+            position=position+1;
+            return true;
+        }
+        return false;
+    }
+    bool ParseString(std::string& result){
+        if(!Expect('"')){
+            return false;
+        }
+        result.clear();
+        while(position<text.size()&&text[position]!='"'){
+            char character=text[position];
+            if(character=='\\'){
+                position=position+1;
+                if(position>=text.size()){
+                    return false;
+                }
+                switch(text[position]){
+                    case 'n':character='\n';break;
+                    case 't':character='\t';break;
+                    case 'r':character='\r';break;
+                    case 'b':character='\b';break;
+                    case 'f':character='\f';break;
+                    case 'u':
+                        // names are ASCII, anything else only has to be skipped
+                        if(position+4>=text.size()){
+                            return false;
+                        }
+                        character=char(strtol(text.substr(position+1,4).c_str(),nullptr,16));
+                        position=position+4;
+                        break;
+                    default:character=text[position];break;
+                }
+            }
+            result.push_back(character);
+            position=position+1;
+        }
+        return Expect('"');
+    }
+public:
+    explicit CompareJsonParser(const std::string& source):text(source){}
+
+    bool Parse(CompareJsonValue& value){
+        SkipSpace();
+        if(position>=text.size()){
+            return false;
+        }
+        char character=text[position];
+        if(character=='{'){
+            value.type=CompareJsonValue::Object;
+            position=position+1;
+            if(Expect('}')){
+                return true;
+            }
+            do{
+                std::pair<std::string,CompareJsonValue> member;
+                if(!ParseString(member.first)||!Expect(':')||!Parse(member.second)){
+                    return false;
+                }
+                value.members.push_back(std::move(member));
+            }while(Expect(','));
+            return Expect('}');
+        }
+        if(character=='['){
+            value.type=CompareJsonValue::Array;
+            position=position+1;
+            if(Expect(']')){
+                return true;
+            }
+            do{
+                CompareJsonValue item;
+                if(!Parse(item)){
+                    return false;
+                }
+                value.items.push_back(std::move(item));
+            }while(Expect(','));
+            return Expect(']');
+        }
+        if(character=='"'){
+            value.type=CompareJsonValue::String;
+            return ParseString(value.text);
+        }
+        if(text.compare(position,4,"true")==0||text.compare(position,5,"false")==0){
+            value.type=CompareJsonValue::Boolean;
+            value.number=text[position]=='t';
+            position=position+(text[position]=='t'?4:5);
+            return true;
+        }
+        if(text.compare(position,4,"null")==0){
+            value.type=CompareJsonValue::Null;
+            position=position+4;
+            return true;
+        }
+        char* end;
+        value.type=CompareJsonValue::Number;
+        value.number=strtod(text.c_str()+position,&end);
+        if(end==text.c_str()+position){
+            return false;
+        }
+        position=end-text.c_str();
+        return true;
+    }
+    bool AtEnd(){
+        SkipSpace();
+        return position==text.size();
+    }
+};
+
+struct CompareCase{
+    std::string name;
+    std::string treeName;
+    double nsPerOperation=0;
+    std::vector<double> samples;
+};
+
+// cases in file order, keyed by "name tree"
+bool CompareLoad(const char* path,std::vector<CompareCase>& cases){
+    FILE* file=fopen(path,"rb");
+    if(!file){
+        fprintf(stderr,"can not open %s\n",path);
+        return false;
+    }
+    std::string text;
+    char buffer[1<<16];
+    size_t readed;
+    while((readed=fread(buffer,1,sizeof(buffer),file))>0){
+        text.append(buffer,readed);
+    }
+    fclose(file);
+    CompareJsonValue root;
+    CompareJsonParser parser(text);
+    if(!parser.Parse(root)||!parser.AtEnd()||root.type!=CompareJsonValue::Array){
+        fprintf(stderr,"%s is not a JSON array written by benchmark --format json\n",path);
+        return false;
+    }
+    for(const CompareJsonValue& item:root.items){
+        const CompareJsonValue* name=item.Member("name");
+        const CompareJsonValue* tree=item.Member("tree");
+        const CompareJsonValue* median=item.Member("ns_per_op");
+        if(!name||!tree||!median){
+            continue;
+        }
+        CompareCase entry;
+        entry.name=name->text;
+        entry.treeName=tree->text;
+        entry.nsPerOperation=median->number;
+        if(const CompareJsonValue* samples=item.Member("samples_ns_per_op")){
+            for(const CompareJsonValue& sample:samples->items){
+                entry.samples.push_back(sample.number);
+            }
+        }
+        cases.push_back(std::move(entry));
+    }
+    return true;
+}
+
+inline double CompareMedian(std::vector<double> values){
+    std::sort(values.begin(),values.end());
+    size_t middle=values.size()/2;
+    return values.size()%2?values[middle]:(values[middle-1]+values[middle])/2;
+}
+
+// P(U>=u) where U counts pairs (a,b) with b>a, a from n samples and b from m samples, all orders equally likely
+inline double CompareExactUpperTail(unsigned n,unsigned m,double u){
+    // counts[j][s]: orderings of i a's and j b's with s pairs b>a, built up one a at a time
+    std::vector<std::vector<double>> counts(m+1,std::vector<double>(n*m+1,0));
+    for(unsigned j=0;j<=m;j=j+1){
+        counts[j][0]=1;
+    }
+    for(unsigned i=1;i<=n;i=i+1){
+        std::vector<std::vector<double>> next(m+1,std::vector<double>(n*m+1,0));
+        next[0][0]=1;
+        for(unsigned j=1;j<=m;j=j+1){
+            for(unsigned s=0;s<=n*m;s=s+1){
+                // the largest value is an a (no new pairs) or a b (greater than all i a's)
+                next[j][s]=counts[j][s]+(s>=i?next[j-1][s-i]:0);
+            }
+        }
+        counts.swap(next);
+    }
+    double total=0,tail=0;
+    for(unsigned s=0;s<=n*m;s=s+1){
+        total=total+counts[m][s];
+        if(s+1e-9>=u){
+            tail=tail+counts[m][s];
+        }
+    }
+    return tail/total;
+}
+
+inline double CompareNormalUpperTail(double z){
+    return 0.5*std::erfc(z/std::sqrt(2.0));
+}
+
+// one-sided p-values of the Mann-Whitney U test: greater (after is slower) and less (after is faster)
+void CompareMannWhitney(const std::vector<double>& before,const std::vector<double>& after,double& pGreater,double& pLess){
+    const unsigned n=unsigned(before.size());
+    const unsigned m=unsigned(after.size());
+    double u=0;
+    bool ties=false;
+    for(double a:before){
+        for(double b:after){
+            if(b>a){
+                u=u+1;
+            }
+            else if(b==a){
+                u=u+0.5;
+                ties=true;
+            }
+        }
+    }
+    if(!ties&&n<=25&&m<=25){
+        pGreater=CompareExactUpperTail(n,m,u);
+        pLess=CompareExactUpperTail(n,m,double(n)*m-u);
+        return;
+    }
+    std::vector<double> all(before);
+    all.insert(all.end(),after.begin(),after.end());
+    std::sort(all.begin(),all.end());
+    double tieTerm=0;
+    for(size_t index=0;index<all.size();){
+        size_t next=index;
+        while(next<all.size()&&all[next]==all[index]){
+            next=next+1;
+        }
+        double count=double(next-index);
+        tieTerm=tieTerm+count*count*count-count;
+        index=next;
+    }
+    const double total=double(n)+m;
+    const double mean=double(n)*m/2;
+    const double variance=double(n)*m/12*((total+1)-tieTerm/(total*(total-1)));
+    if(variance<=0){
+        pGreater=pLess=1;
+        return;
+    }
+    const double deviation=std::sqrt(variance);
+    pGreater=CompareNormalUpperTail((u-mean-0.5)/deviation);
+    pLess=CompareNormalUpperTail((mean-u-0.5)/deviation);
+}
+
+// percentile interval of median(after)/median(before) over resamples of both sides
+void CompareBootstrap(const std::vector<double>& before,const std::vector<double>& after,unsigned resamples,double confidence,PCG32Struct* status,double& low,double& high){
+    std::vector<double> ratios;
+    ratios.reserve(resamples);
+    std::vector<double> left(before.size()),right(after.size());
+    for(unsigned round=0;round<resamples;round=round+1){
+        for(size_t index=0;index<left.size();index=index+1){
+            left[index]=before[PCG32Uniform(status,0,unsigned(before.size()-1))];
+        }
+        for(size_t index=0;index<right.size();index=index+1){
+            right[index]=after[PCG32Uniform(status,0,unsigned(after.size()-1))];
+        }
+        double median=CompareMedian(left);
+        ratios.push_back(median>0?CompareMedian(right)/median:1);
+    }
+    std::sort(ratios.begin(),ratios.end());
+    const double tail=(1-confidence)/2;
+    low=ratios[size_t(tail*(ratios.size()-1))];
+    high=ratios[size_t((1-tail)*(ratios.size()-1)+0.5)];
+}
+
+struct CompareOptions{
+    const char* before=nullptr;
+    const char* after=nullptr;
+    double threshold=5;          // percent
+    double alpha=0.05;
+    double confidence=0.95;
+    unsigned bootstrap=10000;
+    uint64_t seed=20240601;
+    std::string filter;
+};
+
+void CompareUsage(const char* program){
+    fprintf(stderr,"usage: %s OLD.json NEW.json [--threshold PERCENT] [--alpha P] [--confidence C] [--bootstrap N] [--seed N] [--filter TEXT]\n",program);
+}
+
+bool CompareParseOptions(int argc,char** argv,CompareOptions& options){
+    for(int index=1;index<argc;index=index+1){
+        std::string argument=argv[index];
+        if(argument.compare(0,2,"--")!=0){
+            if(!options.before){
+                options.before=argv[index];
+            }
+            else if(!options.after){
+                options.after=argv[index];
+            }
+            else{
+                return false;
+            }
+            continue;
+        }
+        if(index+1>=argc){
+            return false;
+        }
+        std::string value=argv[index+1];
+        index=index+1;
+        if(argument=="--threshold"){
+            options.threshold=atof(value.c_str());
+        }
+        else if(argument=="--alpha"){
+            options.alpha=atof(value.c_str());
+        }
+        else if(argument=="--confidence"){
+            options.confidence=atof(value.c_str());
+        }
+        else if(argument=="--bootstrap"){
+            options.bootstrap=unsigned(strtoul(value.c_str(),nullptr,10));
+        }
+        else if(argument=="--seed"){
+            options.seed=strtoull(value.c_str(),nullptr,10);
+        }
+        else if(argument=="--filter"){
+            options.filter=value;
+        }
+        else{
+            return false;
+        }
+    }
+    return options.before&&options.after&&options.threshold>=0&&options.alpha>0&&options.alpha<1&&
+        options.confidence>0&&options.confidence<1&&options.bootstrap>0;
+}
+
+int main(int argc,char** argv){
+    CompareOptions options;
+    if(!CompareParseOptions(argc,argv,options)){
+        CompareUsage(argv[0]);
+        return 2;
+    }
+    std::vector<CompareCase> before,after;
+    if(!CompareLoad(options.before,before)||!CompareLoad(options.after,after)){
+        return 2;
+    }
+    std::map<std::string,const CompareCase*> beforeByName;
+    for(const CompareCase& entry:before){
+        beforeByName[entry.name+" "+entry.treeName]=&entry;
+    }
+    PCG32Struct status;
+    PCG32SetSeed(&status,options.seed);
+    unsigned regressions=0,improvements=0,unchanged=0,untested=0,missing=0;
+    printf("%-22s %-44s %10s %10s %8s %19s %9s %9s  %s\n","name","tree","old ns/op","new ns/op","change","interval","p slower","p faster","verdict");
+    for(const CompareCase& entry:after){
+        std::string fullName=entry.name+" "+entry.treeName;
+        if(!options.filter.empty()&&fullName.find(options.filter)==std::string::npos){
+            continue;
+        }
+        auto found=beforeByName.find(fullName);
+        if(found==beforeByName.end()){
+            printf("%-22s %-44s %10s %10.2f %8s %19s %9s %9s  %s\n",entry.name.c_str(),entry.treeName.c_str(),"-",entry.nsPerOperation,"-","-","-","-","new case");
+            missing=missing+1;
+            continue;
+        }
+        const CompareCase& old=*found->second;
+        beforeByName.erase(found);
+        if(old.samples.size()<2||entry.samples.size()<2){
+            double change=old.nsPerOperation>0?(entry.nsPerOperation/old.nsPerOperation-1)*100:0;
+            printf("%-22s %-44s %10.2f %10.2f %+7.1f%% %19s %9s %9s  %s\n",entry.name.c_str(),entry.treeName.c_str(),old.nsPerOperation,entry.nsPerOperation,change,"-","-","-","too few samples");
+            untested=untested+1;
+            continue;
+        }
+        const double oldMedian=CompareMedian(old.samples);
+        const double newMedian=CompareMedian(entry.samples);
+        const double change=oldMedian>0?(newMedian/oldMedian-1)*100:0;
+        double pGreater,pLess,low,high;
+        CompareMannWhitney(old.samples,entry.samples,pGreater,pLess);
+        CompareBootstrap(old.samples,entry.samples,options.bootstrap,options.confidence,&status,low,high);
+        const char* verdict="unchanged";
+        if(pGreater<options.alpha&&change>options.threshold){
+            verdict="REGRESSION";
+            regressions=regressions+1;
+        }
+        else if(pLess<options.alpha&&-change>options.threshold){
+            verdict="improvement";
+            improvements=improvements+1;
+        }
+        else{
+            unchanged=unchanged+1;
+        }
+        char interval[64];
+        snprintf(interval,sizeof(interval),"[%+.1f%%,%+.1f%%]",(low-1)*100,(high-1)*100);
+        printf("%-22s %-44s %10.2f %10.2f %+7.1f%% %19s %9.4f %9.4f  %s\n",entry.name.c_str(),entry.treeName.c_str(),oldMedian,newMedian,change,interval,pGreater,pLess,verdict);
+    }
+    for(const auto& removed:beforeByName){
+        if(options.filter.empty()||removed.first.find(options.filter)!=std::string::npos){
+            printf("%-22s %-44s %10.2f %10s %8s %19s %9s %9s  %s\n",removed.second->name.c_str(),removed.second->treeName.c_str(),removed.second->nsPerOperation,"-","-","-","-","-","removed case");
+            missing=missing+1;
+        }
+    }
+    fflush(stdout);
+    fprintf(stderr,"%u regressions, %u improvements, %u unchanged, %u without enough samples, %u only in one run (threshold %.1f%%, alpha %.3f, %.0f%% interval)\n",
+        regressions,improvements,unchanged,untested,missing,options.threshold,options.alpha,options.confidence*100);
+    return regressions>0?1:0;
+}
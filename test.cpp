@@ -1,1126 +1,3097 @@
-#include <iostream>
-#include <map>
-#include <vector>
-#include <string>
-#include <chrono>
-#include <cassert>
-
-// 包含你的随机引擎头文件
-#include "PCG32.h"
-
-// 包含你的RBTreeArray头文件
-#include "RBTreeArrayCXX.h"
-
-using namespace std;
-
-class TestRBTreeArray {
-private:
-    PCG32Struct rng;
-    
-public:
-    TestRBTreeArray() {
-        PCG32SetSeed(&rng, time(NULL));
-    }
-    
-    // 基础功能测试
-    template<typename RBTreeType>
-    void testBasicOperations() {
-        cout << "Testing basic operations..." << endl;
-        
-        RBTreeType tree;
-        map<int, string> stdMap;
-        
-        // 插入测试
-        for (int i = 0; i < 1000; ++i) {
-            int key = PCG32Uniform(&rng, 0, 10000);
-            string value = "value_" + to_string(key);
-            
-            tree.Insert(key, value);
-            stdMap[key] = value;
-        }
-        
-        // 搜索测试
-        for (const auto& pair : stdMap) {
-            string value;
-            bool found = tree.Search(pair.first, value);
-            assert(found && "Key should be found");
-            assert(value == pair.second && "Value should match");
-        }
-        
-        // 最小最大值测试
-        if (!stdMap.empty()) {
-            int minKey, maxKey;
-            string minValue, maxValue;
-            
-            tree.GetMin(minKey, minValue);
-            tree.GetMax(maxKey, maxValue);
-            
-            auto stdMin = stdMap.begin();
-            auto stdMax = stdMap.rbegin();
-            
-            assert(minKey == stdMin->first && "Min key should match");
-            assert(maxKey == stdMax->first && "Max key should match");
-        }
-        
-        cout << "Basic operations test passed!" << endl;
-    }
-    
-    // 删除测试
-    template<typename RBTreeType>
-    void testDeletion() {
-        cout << "Testing deletion..." << endl;
-        
-        RBTreeType tree;
-        map<int, int> stdMap;
-        
-        // 插入一些数据
-        for (int i = 0; i < 500; ++i) {
-            int key = PCG32Uniform(&rng, 0, 1000);
-            tree.Insert(key, key * 2);
-            stdMap[key] = key * 2;
-        }
-        
-        // 随机删除一半的数据
-        vector<int> keysToDelete;
-        for (const auto& pair : stdMap) {
-            if (PCG32Uniform(&rng, 0, 2) == 0) {
-                keysToDelete.push_back(pair.first);
-            }
-        }
-        
-        for (int key : keysToDelete) {
-            tree.Delete(key);
-            stdMap.erase(key);
-        }
-        
-        // 验证剩余数据
-        for (const auto& pair : stdMap) {
-            int value;
-            bool found = tree.Search(pair.first, value);
-            assert(found && "Remaining key should be found");
-            assert(value == pair.second && "Remaining value should match");
-        }
-        
-        // 验证已删除的数据
-        for (int key : keysToDelete) {
-            int value;
-            bool found = tree.Search(key, value);
-            assert(!found && "Deleted key should not be found");
-        }
-        
-        cout << "Deletion test passed!" << endl;
-    }
-    
-    // 性能对比测试
-    template<typename RBTreeType>
-    void testPerformance() {
-        cout << "Testing performance vs std::map..." << endl;
-        
-        RBTreeType tree;
-        map<int, int> stdMap;
-        
-        const int OPERATIONS = 10000;
-        
-        // 插入性能测试
-        auto start = chrono::high_resolution_clock::now();
-        for (int i = 0; i < OPERATIONS; ++i) {
-            int key = PCG32Uniform(&rng, 0, OPERATIONS * 2);
-            tree.Insert(key, i);
-        }
-        auto treeInsertTime = chrono::high_resolution_clock::now() - start;
-        
-        start = chrono::high_resolution_clock::now();
-        for (int i = 0; i < OPERATIONS; ++i) {
-            int key = PCG32Uniform(&rng, 0, OPERATIONS * 2);
-            stdMap[key] = i;
-        }
-        auto mapInsertTime = chrono::high_resolution_clock::now() - start;
-        
-        // 搜索性能测试
-        start = chrono::high_resolution_clock::now();
-        for (int i = 0; i < OPERATIONS; ++i) {
-            int key = PCG32Uniform(&rng, 0, OPERATIONS * 2);
-            int value;
-            tree.Search(key, value);
-        }
-        auto treeSearchTime = chrono::high_resolution_clock::now() - start;
-        
-        start = chrono::high_resolution_clock::now();
-        for (int i = 0; i < OPERATIONS; ++i) {
-            int key = PCG32Uniform(&rng, 0, OPERATIONS * 2);
-            auto it = stdMap.find(key);
-        }
-        auto mapSearchTime = chrono::high_resolution_clock::now() - start;
-        
-        cout << "Insert - RBTree: " 
-             << chrono::duration_cast<chrono::microseconds>(treeInsertTime).count() 
-             << "us, std::map: "
-             << chrono::duration_cast<chrono::microseconds>(mapInsertTime).count() 
-             << "us" << endl;
-        
-        cout << "Search - RBTree: " 
-             << chrono::duration_cast<chrono::microseconds>(treeSearchTime).count() 
-             << "us, std::map: "
-             << chrono::duration_cast<chrono::microseconds>(mapSearchTime).count() 
-             << "us" << endl;
-    }
-    
-    // Transform 测试
-    void testTransform() {
-        cout << "Testing transform between different RBTreeArray types..." << endl;
-        
-        // 创建源树 (16位)
-        RBTreeArray16<int, string> sourceTree;
-        for (int i = 0; i < 100; ++i) {
-            sourceTree.Insert(i, "value_" + to_string(i));
-        }
-        
-        // 转换到32位
-        RBTreeArray32<int, string> targetTree32;
-        bool success32 = targetTree32.Transform(sourceTree);
-        assert(success32 && "Transform to 32-bit should succeed");
-        
-        // 验证数据
-        for (int i = 0; i < 100; ++i) {
-            string value;
-            bool found = targetTree32.Search(i, value);
-            assert(found && "Key should be found after transform");
-            assert(value == "value_" + to_string(i) && "Value should match after transform");
-        }
-        
-        // 转换到64位
-        RBTreeArray64<int, string> targetTree64;
-        bool success64 = targetTree64.Transform(targetTree32);
-        assert(success64 && "Transform to 64-bit should succeed");
-        
-        // 验证数据
-        for (int i = 0; i < 100; ++i) {
-            string value;
-            bool found = targetTree64.Search(i, value);
-            assert(found && "Key should be found after transform");
-            assert(value == "value_" + to_string(i) && "Value should match after transform");
-        }
-        
-        cout << "Transform test passed!" << endl;
-    }
-    
-    // 边界条件测试
-    template<typename RBTreeType>
-    void testEdgeCases() {
-        cout << "Testing edge cases..." << endl;
-        
-        RBTreeType tree;
-        
-        // 空树操作
-        int key, value;
-        assert(!tree.GetMin(key, value) && "GetMin should fail on empty tree");
-        assert(!tree.GetMax(key, value) && "GetMax should fail on empty tree");
-        assert(!tree.Delete(1) && "Delete should fail on empty tree");
-        
-        // 单个元素
-        tree.Insert(1, 100);
-        assert(tree.GetMin(key, value) && key == 1 && value == 100);
-        assert(tree.GetMax(key, value) && key == 1 && value == 100);
-        
-        // 重复插入
-        tree.Insert(1, 200);
-        tree.Search(1, value);
-        assert(value == 200 && "Value should be updated on duplicate insert");
-        
-        // 删除唯一元素
-        assert(tree.Delete(1) && "Delete should succeed");
-        assert(!tree.Search(1, value) && "Search should fail after deletion");
-        
-        cout << "Edge cases test passed!" << endl;
-    }
-    
-    // 运行所有测试
-    void runAllTests() {
-        cout << "=== Testing RBTreeArray16 ===" << endl;
-        testBasicOperations<RBTreeArray16<int, string>>();
-        testDeletion<RBTreeArray16<int, int>>();
-        testPerformance<RBTreeArray16<int, int>>();
-        testEdgeCases<RBTreeArray16<int, int>>();
-        
-        cout << "\n=== Testing RBTreeArray32 ===" << endl;
-        testBasicOperations<RBTreeArray32<int, string>>();
-        testDeletion<RBTreeArray32<int, int>>();
-        testPerformance<RBTreeArray32<int, int>>();
-        testEdgeCases<RBTreeArray32<int, int>>();
-        
-        cout << "\n=== Testing RBTreeArray64 ===" << endl;
-        testBasicOperations<RBTreeArray64<int, string>>();
-        testDeletion<RBTreeArray64<int, int>>();
-        testPerformance<RBTreeArray64<int, int>>();
-        testEdgeCases<RBTreeArray64<int, int>>();
-        
-        cout << "\n=== Testing Transform ===" << endl;
-        testTransform();
-        
-        cout << "\n=== All tests passed! ===" << endl;
-    }
-};
-
-#include <functional>
-
-template<typename Iterator>
-std::function<void(Iterator&)>IteratorNext(){
-    return [](Iterator& iterator){iterator++;};
-}
-
-template<typename Iterator>
-std::function<void(Iterator&)>IteratorPrivious(){
-    return [](Iterator& iterator){iterator--;};
-}
-
-void IteratorTest(){
-    const unsigned size=20;
-    PCG32Struct PCG32Status;
-    PCG32SetSeed(&PCG32Status,time(NULL));
-    RBTreeArray16<unsigned,std::string> tree16;
-    std::map<unsigned,std::string> map16;
-    for(unsigned index=0;index<size;index=index+1){
-        tree16.Insert(index,std::to_string(index));
-        map16[index]=std::to_string(index);
-    }
-    if(true){
-        for(auto iterator=map16.begin();iterator!=map16.end();iterator++){
-            printf("%u, %s\n",iterator->first,iterator->second.c_str());
-        }
-        for(auto iterator=tree16.begin();iterator!=tree16.end();iterator++){
-            printf("%u, %s\n",iterator.Key(),iterator.Value().c_str());
-        }
-    }
-    if(true){
-        printf("===============\n");
-        auto iterator=tree16.end();
-        while(true){
-            iterator--;
-            printf("%u, %s\n",iterator.Key(),iterator.Value().c_str());
-            if(iterator==tree16.begin()){
-                break;
-            }
-        }
-    }
-    if(true){
-        printf("===============\n");
-        auto iterator=tree16.begin();
-        std::function<void(RBTreeArray16<unsigned,std::string>::UnorderedIterator&)> Operation=IteratorNext<RBTreeArray16<unsigned,std::string>::UnorderedIterator>();
-        unsigned count=0;
-        while(count<100){
-            printf("%u, %s\n",iterator.Key(),iterator.Value().c_str());
-            Operation(iterator);
-            count=count+1;
-            if(iterator==tree16.end()){
-                Operation=IteratorPrivious<RBTreeArray16<unsigned,std::string>::UnorderedIterator>();
-                Operation(iterator);
-                continue;
-            }
-            if(iterator==tree16.begin()){
-                printf("%u, %s\n",iterator.Key(),iterator.Value().c_str());
-                Operation(iterator);
-                Operation=IteratorNext<RBTreeArray16<unsigned,std::string>::UnorderedIterator>();
-                Operation(iterator);
-            }
-        }
-    }
-    if(true){
-        RBTreeArray64<unsigned,std::string> tree64;
-        for(auto iterator=tree64.begin();iterator!=tree64.end();iterator++){
-            printf("EMPTY TREE\n!");
-        }
-    }
-    if(true){
-        RBTreeArray64<unsigned,double> tree64={{1,2},{3,4},{5,6}};
-        for(auto iterator=tree64.begin();iterator!=tree64.end();iterator++){
-            printf("%u, %lf\n",iterator.Key(),iterator.Value());
-        }
-    }
-    if(true){
-        RBTreeArray64<unsigned,double> tree64={{1,2},{3,4},{5,6}};
-        for(unsigned index=0;index<64;index=index+1){
-            const double pi=3.1415926535897932384626433832795;
-            tree64[index]=index*pi;
-        }
-        for(auto iterator=tree64.UnorderedBegin();iterator!=tree64.UnorderedEnd();iterator++){
-            printf("%u, %lf\n",iterator.Key(),iterator.Value());
-        }
-    }
-}
-
-static inline bool IfDelete_10Outof1(unsigned key,unsigned value){
-    // return false;
-    // return key%101==0;
-    // return true;
-    // return key%2==0;
-    // return key%4==0;
-    return key%10==0;
-}
-
-static inline bool IfDelete(unsigned key,unsigned value){
-    // return false;
-    // return key%101==0;
-    // return true;
-    // return key%2==0;
-    // return key%4==0;
-    return key%3==0;
-}
-
-static inline bool IfDeleteRandom(const std::string& key,const std::vector<std::string>& value,PCG32Struct* PCGStatus){
-    return stoi(key)%11==0;
-    return true;
-    return PCG32Uniform_Strict(PCGStatus,0,10)<0;
-}
-
-template<typename RBTreeArray,typename Map>
-bool NodeCompare(const RBTreeArray& tree,const Map& map){
-    if(tree.KeyCount()!=map.size()){
-        return false;
-    }
-    auto OrderedIterator=tree.OrderedBegin();
-    auto mapIterator=map.begin();
-    while(OrderedIterator!=tree.OrderedEnd()){
-        if(OrderedIterator.Key()!=mapIterator->first){
-            return false;
-        }
-        ++mapIterator;
-        ++OrderedIterator;
-    }
-    return true;
-}
-
-#include <sys/time.h>
-
-template<typename RBTreeArray,typename Map>
-void SpeedTestTemplate(RBTreeArray& tree,Map& map,const long long unsigned int Case){
-
-    PCG32Struct PCGStatus;
-    PCG32SetSeed(&PCGStatus,time(NULL));
-
-    unsigned* keys=(unsigned*)malloc(sizeof(unsigned)*Case);
-    unsigned* UnorderedKeysCopy=(unsigned*)malloc(sizeof(unsigned)*Case);
-    for(long long unsigned int index=0;index<Case;index=index+1){
-        keys[index]=PCG32(&PCGStatus);
-    }
-    memcpy(UnorderedKeysCopy,(const unsigned*)keys,sizeof(unsigned)*Case);
-    PCG32UniformShuffle(&PCGStatus,UnorderedKeysCopy,Case);
-
-    struct timeval start,end;
-    unsigned millisecondsRBTreeArray=0;
-    unsigned millisecondsStdmap=0;
-
-    gettimeofday(&start,NULL);
-    for(long long unsigned int index=0;index<Case;index=index+1){
-        tree.Insert(keys[index],index);
-    }
-    gettimeofday(&end,NULL);
-    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-    
-    gettimeofday(&start,NULL);
-    for(long long unsigned int index=0;index<Case;index=index+1){
-        map[keys[index]]=index;
-    }
-    gettimeofday(&end,NULL);
-    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    if(!NodeCompare(tree,map)){
-        char errorMassage[1024];
-        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-        throw std::logic_error(errorMassage);
-    }
-
-    printf("  Insert: RBTreeArray%u<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",tree.GetBitLength(),millisecondsRBTreeArray,millisecondsStdmap);
-
-    RBTree* treeCopy=(RBTree*)malloc(tree.ByteSize());
-    memcpy(treeCopy,(const RBTree*)tree.Data(),tree.ByteSize());
-
-    gettimeofday(&start,NULL);
-    unsigned valueRBTreeArray;
-    for(long long unsigned int index=0;index<Case;index=index+1){
-        tree.Search(UnorderedKeysCopy[index],valueRBTreeArray);
-    }
-    gettimeofday(&end,NULL);
-    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    gettimeofday(&start,NULL);
-    unsigned valueStdmap;
-    for(long long unsigned int index=0;index<Case;index=index+1){
-        valueStdmap=map.at(UnorderedKeysCopy[index]);
-    }
-    gettimeofday(&end,NULL);
-    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    if(valueRBTreeArray!=valueStdmap){
-        char errorMassage[1024];
-        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-        throw std::logic_error(errorMassage);
-    }
-
-    if(!NodeCompare(tree,map)){
-        char errorMassage[1024];
-        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-        throw std::logic_error(errorMassage);
-    }
-
-    printf("  Search: RBTreeArray%u<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",tree.GetBitLength(),millisecondsRBTreeArray,millisecondsStdmap);
-
-    long long unsigned int sum[2]={0LLU};
-    gettimeofday(&start,NULL);
-    for(auto iterator=tree.UnorderedBegin();iterator!=tree.UnorderedEnd();++iterator){
-        sum[0]=sum[0]+iterator.Key();
-    }
-    gettimeofday(&end,NULL);
-    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    gettimeofday(&start,NULL);
-    for(auto iterator=map.begin();iterator!=map.end();++iterator){
-        sum[1]=sum[1]+iterator->first;
-    }
-    gettimeofday(&end,NULL);
-    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    if(sum[0]!=sum[1]){
-        char errorMassage[1024];
-        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-        throw std::logic_error(errorMassage);
-    }
-
-    if(!NodeCompare(tree,map)){
-        char errorMassage[1024];
-        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-        throw std::logic_error(errorMassage);
-    }
-
-    printf("  Loop Through: RBTreeArray%u<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",tree.GetBitLength(),millisecondsRBTreeArray,millisecondsStdmap);
-
-    gettimeofday(&start,NULL);
-    for(long long unsigned int index=0;index<Case;index=index+1){
-        tree.Delete(UnorderedKeysCopy[index]);
-    }
-    gettimeofday(&end,NULL);
-    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    gettimeofday(&start,NULL);
-    for(long long unsigned int index=0;index<Case;index=index+1){
-        map.erase(UnorderedKeysCopy[index]);
-    }
-    gettimeofday(&end,NULL);
-    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    if(!NodeCompare(tree,map)){
-        char errorMassage[1024];
-        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-        throw std::logic_error(errorMassage);
-    }
-
-    printf("  Delete: RBTreeArray%u<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",tree.GetBitLength(),millisecondsRBTreeArray,millisecondsStdmap);
-
-    tree.SetTree(treeCopy);
-    for(long long unsigned int index=0;index<Case;index=index+1){
-        map[keys[index]]=index;
-    }
-    if(!NodeCompare(tree,map)){
-        char errorMassage[1024];
-        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-        throw std::logic_error(errorMassage);
-    }
-
-    auto iteratorArray=tree.OrderedBegin();
-    for(auto iterator=map.begin();iterator!=map.end();iterator++){
-        if(iteratorArray.Key()!=iterator->first){
-            printf("%u, %u\n",iteratorArray.Key(),iterator->first);
-            char errorMassage[1024];
-            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-            throw std::logic_error(errorMassage);
-        }
-        iteratorArray++;
-    }
-    if(iteratorArray!=tree.OrderedEnd()){
-        char errorMassage[1024];
-        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-        throw std::logic_error(errorMassage);
-    }
-
-    gettimeofday(&start,NULL);
-    unsigned deleted=tree.ConditionalDelete(IfDelete);
-    gettimeofday(&end,NULL);
-    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    gettimeofday(&start,NULL);
-    for(auto iterator=map.begin();iterator!=map.end();){
-        if(IfDelete(iterator->first,iterator->second)){
-            iterator=map.erase(iterator);
-        }else{
-            ++iterator;
-        }
-    }
-    gettimeofday(&end,NULL);
-    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    if(!NodeCompare(tree,map)){
-        char errorMassage[1024];
-        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-        throw std::logic_error(errorMassage);
-    }
-
-    printf("  Conditional Delete 1/3 keys: RBTreeArray%u<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",tree.GetBitLength(),millisecondsRBTreeArray,millisecondsStdmap);
-
-    for(long long unsigned int index=0;index<Case;index=index+1){
-        tree[keys[index]]=index;
-        map[keys[index]]=index;
-    }
-    if(!NodeCompare(tree,map)){
-        char errorMassage[1024];
-        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-        throw std::logic_error(errorMassage);
-    }
-
-    gettimeofday(&start,NULL);
-    {
-        unsigned deleted=tree.ConditionalDelete(IfDelete_10Outof1);
-    }
-    gettimeofday(&end,NULL);
-
-    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-    gettimeofday(&start,NULL);
-    for(auto iterator=map.begin();iterator!=map.end();){
-        if(IfDelete_10Outof1(iterator->first,iterator->second)){
-            iterator=map.erase(iterator);
-        }else{
-            ++iterator;
-        }
-    }
-    gettimeofday(&end,NULL);
-    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    if(!NodeCompare(tree,map)){
-        char errorMassage[1024];
-        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-        throw std::logic_error(errorMassage);
-    }
-    printf("  Conditional Delete 1/10 keys: RBTreeArray%u<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",tree.GetBitLength(),millisecondsRBTreeArray,millisecondsStdmap);
-
-}
-
-void SpecialSpeed16(){
-    constexpr unsigned scale=128;
-    RBTreeArray16<unsigned,unsigned> trees[scale];
-    std::map<unsigned,unsigned> maps[scale];
-    for(unsigned index=0;index<scale;index=index+1){
-        trees[index].ReSize(65535);
-    }
-    PCG32Struct PCGStatus;
-    PCG32SetSeed(&PCGStatus,time(NULL));
-
-    unsigned keys[65535];
-    unsigned UnorderedKeysCopy[65535];
-    for(long long unsigned int index=0;index<65535;index=index+1){
-        keys[index]=PCG32(&PCGStatus);
-    }
-    memcpy(UnorderedKeysCopy,(const unsigned*)keys,sizeof(unsigned)*65535);
-    PCG32UniformShuffle(&PCGStatus,UnorderedKeysCopy,65535);
-
-    struct timeval start,end;
-    unsigned millisecondsRBTreeArray=0;
-    unsigned millisecondsStdmap=0;
-
-    gettimeofday(&start,NULL);
-    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
-        for(unsigned index=0;index<65535;index=index+1){
-            trees[indexTree].Insert(keys[index],index);
-        }
-    }
-    gettimeofday(&end,NULL);
-    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    gettimeofday(&start,NULL);
-    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
-        for(unsigned index=0;index<65535;index=index+1){
-            maps[indexTree][keys[index]]=index;
-        }
-    }
-    gettimeofday(&end,NULL);
-    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    printf("  Insert: RBTreeArray16<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",millisecondsRBTreeArray,millisecondsStdmap);
-
-    gettimeofday(&start,NULL);
-    long long unsigned int searchSum[2]={0};
-    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
-        for(unsigned index=0;index<65535;index=index+1){
-            unsigned search;
-            trees[indexTree].Search(UnorderedKeysCopy[index],search);
-            searchSum[0]=searchSum[0]+search;
-        }
-    }
-    gettimeofday(&end,NULL);
-    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    gettimeofday(&start,NULL);
-    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
-        for(unsigned index=0;index<65535;index=index+1){
-            unsigned valueStdmap=maps[indexTree].at(UnorderedKeysCopy[index]);
-            searchSum[1]=searchSum[1]+valueStdmap;
-        }
-    }
-    gettimeofday(&end,NULL);
-    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    if(searchSum[0]!=searchSum[1]){
-        char errorMassage[1024];
-        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-        throw std::logic_error(errorMassage);
-    }
-
-    printf("  Search: RBTreeArray16<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",millisecondsRBTreeArray,millisecondsStdmap);
-
-    long long unsigned int sum[2]={0LLU};
-    gettimeofday(&start,NULL);
-    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
-        for(auto iterator=trees[indexTree].UnorderedBegin();iterator!=trees[indexTree].UnorderedEnd();++iterator){
-            sum[0]=sum[0]+iterator.Key();
-        }
-    }
-    gettimeofday(&end,NULL);
-    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    gettimeofday(&start,NULL);
-    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
-        for(auto iterator=maps[indexTree].begin();iterator!=maps[indexTree].end();++iterator){
-            sum[1]=sum[1]+iterator->first;
-        }
-    }
-    gettimeofday(&end,NULL);
-    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    if(sum[0]!=sum[1]){
-        char errorMassage[1024];
-        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-        throw std::logic_error(errorMassage);
-    }
-
-    printf("  Loop Through: RBTreeArray16<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",millisecondsRBTreeArray,millisecondsStdmap);
-
-    gettimeofday(&start,NULL);
-    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
-        for(long long unsigned int index=0;index<65535;index=index+1){
-            trees[indexTree].Delete(UnorderedKeysCopy[index]);
-        }
-    }
-    gettimeofday(&end,NULL);
-    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    gettimeofday(&start,NULL);
-    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
-        for(long long unsigned int index=0;index<65535;index=index+1){
-            maps[indexTree].erase(UnorderedKeysCopy[index]);
-        }
-    }
-    gettimeofday(&end,NULL);
-    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    printf("  Delete: RBTreeArray16<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",millisecondsRBTreeArray,millisecondsStdmap);
-
-    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
-        for(unsigned index=0;index<65535;index=index+1){
-            trees[indexTree].Insert(keys[index],index);
-            maps[indexTree][keys[index]]=index;
-        }
-    }
-
-    gettimeofday(&start,NULL);
-    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
-        unsigned deleted=trees[indexTree].ConditionalDelete(IfDelete);
-    }
-    gettimeofday(&end,NULL);
-    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    gettimeofday(&start,NULL);
-    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
-        for(auto iterator=maps[indexTree].begin();iterator!=maps[indexTree].end();){
-            if(IfDelete(iterator->first,iterator->second)){
-                iterator=maps[indexTree].erase(iterator);
-            }else{
-                ++iterator;
-            }
-        }
-    }
-    gettimeofday(&end,NULL);
-    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    printf("  Conditional Delete 1/3 keys: RBTreeArray16<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",millisecondsRBTreeArray,millisecondsStdmap);
-
-    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
-        for(unsigned index=0;index<65535;index=index+1){
-            trees[indexTree].Insert(keys[index],index);
-            maps[indexTree][keys[index]]=index;
-        }
-    }
-
-    gettimeofday(&start,NULL);
-    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
-        unsigned deleted=trees[indexTree].ConditionalDelete(IfDelete_10Outof1);
-    }
-    gettimeofday(&end,NULL);
-    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    gettimeofday(&start,NULL);
-    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
-        for(auto iterator=maps[indexTree].begin();iterator!=maps[indexTree].end();){
-            if(IfDelete_10Outof1(iterator->first,iterator->second)){
-                iterator=maps[indexTree].erase(iterator);
-            }else{
-                ++iterator;
-            }
-        }
-    }
-    gettimeofday(&end,NULL);
-    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
-
-    printf("  Conditional Delete 1/10 keys: RBTreeArray16<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",millisecondsRBTreeArray,millisecondsStdmap);
-}
-
-void SpeedTest(){
-    long long unsigned int Case=1234567*2LLU;
-    if(false){
-        printf("RBTreeArray16:\n");
-        RBTreeArray16<unsigned,unsigned> tree16;
-        std::map<unsigned,unsigned> map;
-        SpeedTestTemplate(tree16,map,65535);
-    }else{
-        printf("RBTreeArray16:\n");
-        SpecialSpeed16();
-    }
-    if(true){
-        printf("RBTreeArray32:\n");
-        RBTreeArray32<unsigned,unsigned> tree32;
-        std::map<unsigned,unsigned> map;
-        SpeedTestTemplate(tree32,map,Case);
-    }
-    if(true){
-        printf("RBTreeArray64:\n");
-        RBTreeArray64<unsigned,unsigned> tree64;
-        std::map<unsigned,unsigned> map;
-        SpeedTestTemplate(tree64,map,Case);
-    }
-}
-
-void BoundaryTest(){
-    if(true){
-        PCG32Struct PCGStatus;
-        PCG32SetSeed(&PCGStatus,time(NULL));
-        unsigned length=PCG32Uniform_Strict(&PCGStatus,10000,50000);
-
-        RBTreeArray64<std::string,std::pair<double,std::vector<std::string>>> tree={{"3.1415926",{3.1415926,{"3",".","1","4"}}}};
-        for(unsigned index=0;index<length;index=index+1){
-            std::string key=std::to_string(PCG32Uniform_Strict(&PCGStatus,100000,200000));
-            std::vector<std::string> vector;
-            for(const char c:key){
-                vector.push_back({c});
-            }
-            tree[key]={PCG32UniformReal(&PCGStatus,0,1),vector};
-        }
-        unsigned treeSize=tree.KeyCount();
-        RBTreeArray64<std::string,std::pair<double,std::vector<std::string>>> treeCopy=tree;
-        if(treeCopy.KeyCount()!=tree.KeyCount()||tree.KeyCount()!=treeSize){
-            char errorMassage[1024];
-            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-            throw std::logic_error(errorMassage);
-        }
-        RBTreeArray64<std::string,std::pair<double,std::vector<std::string>>> treeMove=std::move(tree);
-        if(tree.KeyCount()!=0||treeMove.KeyCount()!=treeSize){
-            char errorMassage[1024];
-            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-            throw std::logic_error(errorMassage);
-        }
-    }
-    if(true){
-        RBTreeArray16<unsigned,unsigned> tree16;
-        tree16.ConditionalDelete([](const unsigned key,unsigned value){return (bool)(key&1);});
-        tree16[1]=1;
-        tree16.ConditionalDelete([](const unsigned key,unsigned value){return (bool)(key&1);});
-        tree16.ConditionalDelete([](const unsigned key,unsigned value){return (bool)(key&1);});
-        tree16.Delete(0);
-        tree16.Delete(1);
-        unsigned search;
-        tree16.Search(1,search);
-        RBTreeArray32<unsigned,unsigned> tree32;
-        tree32.Transform(tree16);
-        tree16.Transform(tree32);
-        tree16[1]=1;
-        tree32.Transform(tree16);
-        search=0;
-        tree32.Search(1,search);
-        if(search!=1){
-            throw std::logic_error("RBTreeArray error");
-        }
-        // tree16=tree32;
-    }
-    if(true){
-        PCG32Struct PCGStatus;
-        PCG32SetSeed(&PCGStatus,time(NULL));
-
-        RBTreeArray16<std::string,std::vector<std::string>> tree16={{"Hellor",{"H","e","l","l","o"}}};
-        std::string string="World!";
-        
-        for(unsigned index=0;index<10;index=index+1){
-            std::vector<std::string> vector;
-            for(const char c:string){
-                vector.push_back({c});
-            }
-            tree16.Insert(string,vector);
-            string=std::to_string(PCG32Uniform(&PCGStatus,0,999));
-        }
-        for(auto iterator=tree16.UnorderedBegin();iterator!=tree16.UnorderedEnd();iterator++){
-            std::cout<<iterator.Key()<<": ";
-            for(const auto iteratorVector:iterator.Value()){
-                std::cout<<iteratorVector<<", ";
-            }
-            printf("\n");
-        }
-        RBTreeArray32<std::string,std::vector<std::string>> tree32;
-        tree32.Transform(tree16);
-        for(auto iterator=tree32.UnorderedBegin();iterator!=tree32.UnorderedEnd();iterator++){
-            std::cout<<iterator.Key()<<": ";
-            for(const auto iteratorVector:iterator.Value()){
-                std::cout<<iteratorVector<<", ";
-            }
-            printf("\n");
-        }
-        RBTreeArray32<std::string,std::vector<std::string>> tree32Copy;
-        tree32Copy=tree32;
-    }
-    if(true){
-        RBTreeArray32<unsigned,double> tree32={{1,2},{3,4},{5,6}};
-        for(const auto& [key,value]:tree32){
-            printf("%u,%lf\n",key,value);
-        }
-    }
-    if(true){
-        PCG32Struct PCGStatus;
-        PCG32SetSeed(&PCGStatus,time(NULL));
-        std::map<std::string,std::vector<std::string>> map;
-        RBTreeArray32<std::string,std::vector<std::string>> tree;
-        unsigned length=PCG32Uniform_Strict(&PCGStatus,10000,50000);
-        for(unsigned index=0;index<length;index=index+1){
-            std::string key=std::to_string(PCG32Uniform_Strict(&PCGStatus,100000,200000));
-            std::vector<std::string> vector;
-            for(const char c:key){
-                vector.push_back({c});
-            }
-            map[key]=vector;
-            tree[key]=vector;
-        }
-        if(!NodeCompare(tree,map)){
-            char errorMassage[1024];
-            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-            throw std::logic_error(errorMassage);
-        }
-        RBTreeArray32<std::string,std::vector<std::string>> trees[10];
-        trees[0]=std::move(tree);
-        tree.Insert("test",{"0","1","2","3"});
-        for(unsigned index=1;index<10;index=index+1){
-            trees[index]=trees[index-1];
-        }
-        if(!NodeCompare(trees[9],map)){
-            char errorMassage[1024];
-            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-            throw std::logic_error(errorMassage);
-        }
-    }
-    printf("BoundaryTest passed\n========================\n");
-}
-
-void SpecialTestConditionalDelete(){
-    PCG32Struct PCGStatus;
-    PCG32SetSeed(&PCGStatus,123456789);
-
-    RBTreeArray32<unsigned,unsigned> treeBase;
-    RBTreeArray32<unsigned,unsigned> tree;
-    std::map<unsigned,unsigned> mapBase;
-    std::map<unsigned,unsigned> map;
-
-    long long unsigned int Case=1<<20;
-    unsigned* keys=(unsigned*)malloc(sizeof(unsigned)*Case);
-    for(long long unsigned int index=0;index<Case;index=index+1){
-        keys[index]=PCG32(&PCGStatus);
-    }
-
-    for(long long unsigned int index=0;index<Case;index=index+1){
-        treeBase[keys[index]]=index;
-        mapBase[keys[index]]=index;
-    }
-
-    RBTree* treeCopy=(RBTree*)malloc(treeBase.ByteSize());
-    memcpy(treeCopy,treeBase.Data(),treeBase.ByteSize());
-    long long unsigned int deleted;
-    long long unsigned int mapDelete;
-    if(false){
-        map=mapBase;
-        tree.SetTree(treeCopy);
-        deleted=tree.ConditionalDelete(IfDelete);
-        mapDelete=map.size();
-        for(auto iterator=map.begin();iterator!=map.end();){
-            if(IfDelete(iterator->first,iterator->second)){
-                iterator=map.erase(iterator);
-            }else{
-                ++iterator;
-            }
-        }
-        mapDelete=mapDelete-map.size();
-        if(tree.KeyCount()!=map.size()){
-            char errorMassage[1024];
-            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-            throw std::logic_error(errorMassage);
-        }
-    }
-    if(true){
-        std::map<std::string,std::vector<std::string>> map;
-        RBTreeArray32<std::string,std::vector<std::string>> tree;
-        unsigned length=PCG32Uniform_Strict(&PCGStatus,10000,50000);
-        for(unsigned index=0;index<length;index=index+1){
-            std::string key=std::to_string(PCG32Uniform_Strict(&PCGStatus,100000,200000));
-            std::vector<std::string> vector;
-            for(const char c:key){
-                vector.push_back({c});
-            }
-            map[key]=vector;
-            tree[key]=vector;
-        }
-        mapDelete=map.size();
-        PCG32Struct PCGStatus0,PCGStatus1;
-        PCG32SetSeed(&PCGStatus0,1234567);
-        PCG32SetSeed(&PCGStatus1,1234567);
-        deleted=tree.ConditionalDelete(IfDeleteRandom,&PCGStatus0);
-        for(auto iterator=map.begin();iterator!=map.end();){
-            if(IfDeleteRandom(iterator->first,iterator->second,&PCGStatus1)){
-                iterator=map.erase(iterator);
-            }else{
-                ++iterator;
-            }
-        }
-        mapDelete=mapDelete-map.size();
-        if(tree.KeyCount()!=map.size()){
-            char errorMassage[1024];
-            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-            throw std::logic_error(errorMassage);
-        }
-        if(!NodeCompare(tree,map)){
-            char errorMassage[1024];
-            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
-            throw std::logic_error(errorMassage);
-        }
-    }
-    free(keys);
-}
-
-#include <sys/resource.h>
-#include <unistd.h>
-
-void getDetailedMemoryInfo() {
-    // 从 /proc/self/statm 获取详细信息
-    FILE *fp = fopen("/proc/self/status", "r");
-    if (!fp) {
-        perror("fopen");
-        return;
-    }
-    
-    char line[256];
-    long vmrss_kb = 0;
-    long vmhwm_kb = 0;
-    long vmsize_kb = 0;
-    long vmswap_kb = 0;
-    
-    while (fgets(line, sizeof(line), fp)) {
-        // 当前物理内存使用
-        if (strncmp(line, "VmRSS:", 6) == 0) {
-            sscanf(line + 6, "%ld", &vmrss_kb);
-        }
-        // 物理内存峰值
-        else if (strncmp(line, "VmHWM:", 6) == 0) {
-            sscanf(line + 6, "%ld", &vmhwm_kb);
-        }
-        // 虚拟内存大小
-        else if (strncmp(line, "VmSize:", 7) == 0) {
-            sscanf(line + 7, "%ld", &vmsize_kb);
-        }
-        // SWAP使用量
-        else if (strncmp(line, "VmSwap:", 7) == 0) {
-            sscanf(line + 7, "%ld", &vmswap_kb);
-        }
-        // 数据段大小
-        else if (strncmp(line, "VmData:", 7) == 0) {
-            long vmdata_kb;
-            sscanf(line + 7, "%ld", &vmdata_kb);
-            // printf("数据段大小: %ld KB\n", vmdata_kb);
-        }
-        // 栈大小
-        else if (strncmp(line, "VmStk:", 6) == 0) {
-            long vmstk_kb;
-            sscanf(line + 6, "%ld", &vmstk_kb);
-            // printf("栈大小: %ld KB\n", vmstk_kb);
-        }
-    }
-    
-    fclose(fp);
-    
-    printf("\n=== 实时内存状态 ===\n");
-    printf("当前物理内存(VmRSS): %ld KB (%.2f MB)\n", 
-           vmrss_kb, vmrss_kb / 1024.0);
-    printf("物理内存峰值(VmHWM): %ld KB (%.2f MB)\n", 
-           vmhwm_kb, vmhwm_kb / 1024.0);
-    printf("虚拟内存大小(VmSize): %ld KB (%.2f MB)\n", 
-           vmsize_kb, vmsize_kb / 1024.0);
-    if (vmswap_kb > 0) {
-        printf("SWAP使用量(VmSwap): %ld KB\n", vmswap_kb);
-    }
-}
-
-void MemoryTest(){
-    RBTreeArray32<std::string,std::vector<std::string>> tree;
-    PCG32Struct PCGStatus;
-    PCG32SetSeed(&PCGStatus,time(NULL));
-    getDetailedMemoryInfo();
-
-    unsigned insertTimes=1<<23;
-    for(unsigned index=0;index<insertTimes;index=index+1){
-        tree.Insert(std::to_string(PCG32(&PCGStatus)),{std::to_string(PCG32(&PCGStatus)),std::to_string(PCG32UniformReal(&PCGStatus,0,3.1415926535))});
-    }
-    tree.MemoryShrink();
-    getDetailedMemoryInfo();
-    for(unsigned index=0;index<insertTimes;index=index+1){
-        if(PCG32(&PCGStatus)&1){
-            tree.Insert(std::to_string(PCG32(&PCGStatus)),{std::to_string(PCG32(&PCGStatus)),std::to_string(PCG32UniformReal(&PCGStatus,0,3.1415926535))});
-        }else{
-            std::string search=std::to_string(PCG32(&PCGStatus));
-            std::string toDelete;
-            std::vector<std::string> value;
-            if(tree.GetBiggestSmallerThan(search,toDelete,value)){
-
-            }else{
-                tree.GetSmallestGraterThan(search,toDelete,value);
-            }
-            tree.Delete(toDelete);
-        }
-    }
-    tree.MemoryShrink();
-    getDetailedMemoryInfo();
-    tree.Clear();
-    tree.MemoryShrink();
-    getDetailedMemoryInfo();
-}
-
-int main() {
-    TestRBTreeArray tester;
-    tester.runAllTests();
-    
-    BoundaryTest();
-
-    IteratorTest();
-    SpecialTestConditionalDelete();
-    
-    SpeedTest();
-
-    // MemoryTest();
-    return 0;
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <climits>
+
+// 包含你的随机引擎头文件
+#include "PCG32.h"
+
+// tree blocks and scratch buffers are counted, AllocationHookTest checks that every one is given back
+#include <cstdlib>
+static long long testHeapBlocks=0;
+static unsigned long long testHeapAllocations=0;
+inline void* TestMalloc(size_t size){
+    void* pointer=malloc(size);
+    if(pointer){
+        testHeapBlocks=testHeapBlocks+1;
+        testHeapAllocations=testHeapAllocations+1;
+    }
+    return pointer;
+}
+inline void* TestRealloc(void* pointer,size_t size){
+    void* newPointer=realloc(pointer,size);
+    if(newPointer&&!pointer){
+        testHeapBlocks=testHeapBlocks+1;
+        testHeapAllocations=testHeapAllocations+1;
+    }
+    return newPointer;
+}
+inline void TestFree(void* pointer){
+    if(pointer){
+        testHeapBlocks=testHeapBlocks-1;
+    }
+    free(pointer);
+}
+#define RBTREE_ARRAY_MALLOC TestMalloc
+#define RBTREE_ARRAY_REALLOC TestRealloc
+#define RBTREE_ARRAY_FREE TestFree
+
+// 包含你的RBTreeArray头文件
+#include "RBTreeArrayCXX.h"
+
+using namespace std;
+
+class TestRBTreeArray {
+private:
+    PCG32Struct rng;
+    
+public:
+    TestRBTreeArray() {
+        PCG32SetSeed(&rng, time(NULL));
+    }
+    
+    // 基础功能测试
+    template<typename RBTreeType>
+    void testBasicOperations() {
+        cout << "Testing basic operations..." << endl;
+        
+        RBTreeType tree;
+        map<int, string> stdMap;
+        
+        // 插入测试
+        for (int i = 0; i < 1000; ++i) {
+            int key = PCG32Uniform(&rng, 0, 10000);
+            string value = "value_" + to_string(key);
+            
+            tree.Insert(key, value);
+            stdMap[key] = value;
+        }
+        
+        // 搜索测试
+        for (const auto& pair : stdMap) {
+            string value;
+            bool found = tree.Search(pair.first, value);
+            assert(found && "Key should be found");
+            assert(value == pair.second && "Value should match");
+        }
+        
+        // 最小最大值测试
+        if (!stdMap.empty()) {
+            int minKey, maxKey;
+            string minValue, maxValue;
+            
+            tree.GetMin(minKey, minValue);
+            tree.GetMax(maxKey, maxValue);
+            
+            auto stdMin = stdMap.begin();
+            auto stdMax = stdMap.rbegin();
+            
+            assert(minKey == stdMin->first && "Min key should match");
+            assert(maxKey == stdMax->first && "Max key should match");
+        }
+        
+        cout << "Basic operations test passed!" << endl;
+    }
+    
+    // 删除测试
+    template<typename RBTreeType>
+    void testDeletion() {
+        cout << "Testing deletion..." << endl;
+        
+        RBTreeType tree;
+        map<int, int> stdMap;
+        
+        // 插入一些数据
+        for (int i = 0; i < 500; ++i) {
+            int key = PCG32Uniform(&rng, 0, 1000);
+            tree.Insert(key, key * 2);
+            stdMap[key] = key * 2;
+        }
+        
+        // 随机删除一半的数据
+        vector<int> keysToDelete;
+        for (const auto& pair : stdMap) {
+            if (PCG32Uniform(&rng, 0, 2) == 0) {
+                keysToDelete.push_back(pair.first);
+            }
+        }
+        
+        for (int key : keysToDelete) {
+            tree.Delete(key);
+            stdMap.erase(key);
+        }
+        
+        // 验证剩余数据
+        for (const auto& pair : stdMap) {
+            int value;
+            bool found = tree.Search(pair.first, value);
+            assert(found && "Remaining key should be found");
+            assert(value == pair.second && "Remaining value should match");
+        }
+        
+        // 验证已删除的数据
+        for (int key : keysToDelete) {
+            int value;
+            bool found = tree.Search(key, value);
+            assert(!found && "Deleted key should not be found");
+        }
+        
+        cout << "Deletion test passed!" << endl;
+    }
+    
+    // 性能对比测试
+    template<typename RBTreeType>
+    void testPerformance() {
+        cout << "Testing performance vs std::map..." << endl;
+        
+        RBTreeType tree;
+        map<int, int> stdMap;
+        
+        const int OPERATIONS = 10000;
+        
+        // 插入性能测试
+        auto start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < OPERATIONS; ++i) {
+            int key = PCG32Uniform(&rng, 0, OPERATIONS * 2);
+            tree.Insert(key, i);
+        }
+        auto treeInsertTime = chrono::high_resolution_clock::now() - start;
+        
+        start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < OPERATIONS; ++i) {
+            int key = PCG32Uniform(&rng, 0, OPERATIONS * 2);
+            stdMap[key] = i;
+        }
+        auto mapInsertTime = chrono::high_resolution_clock::now() - start;
+        
+        // 搜索性能测试
+        start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < OPERATIONS; ++i) {
+            int key = PCG32Uniform(&rng, 0, OPERATIONS * 2);
+            int value;
+            tree.Search(key, value);
+        }
+        auto treeSearchTime = chrono::high_resolution_clock::now() - start;
+        
+        start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < OPERATIONS; ++i) {
+            int key = PCG32Uniform(&rng, 0, OPERATIONS * 2);
+            auto it = stdMap.find(key);
+        }
+        auto mapSearchTime = chrono::high_resolution_clock::now() - start;
+        
+        cout << "Insert - RBTree: " 
+             << chrono::duration_cast<chrono::microseconds>(treeInsertTime).count() 
+             << "us, std::map: "
+             << chrono::duration_cast<chrono::microseconds>(mapInsertTime).count() 
+             << "us" << endl;
+        
+        cout << "Search - RBTree: " 
+             << chrono::duration_cast<chrono::microseconds>(treeSearchTime).count() 
+             << "us, std::map: "
+             << chrono::duration_cast<chrono::microseconds>(mapSearchTime).count() 
+             << "us" << endl;
+    }
+    
+    // Transform 测试
+    void testTransform() {
+        cout << "Testing transform between different RBTreeArray types..." << endl;
+        
+        // 创建源树 (16位)
+        RBTreeArray16<int, string> sourceTree;
+        for (int i = 0; i < 100; ++i) {
+            sourceTree.Insert(i, "value_" + to_string(i));
+        }
+        
+        // 转换到32位
+        RBTreeArray32<int, string> targetTree32;
+        bool success32 = targetTree32.Transform(sourceTree);
+        assert(success32 && "Transform to 32-bit should succeed");
+        
+        // 验证数据
+        for (int i = 0; i < 100; ++i) {
+            string value;
+            bool found = targetTree32.Search(i, value);
+            assert(found && "Key should be found after transform");
+            assert(value == "value_" + to_string(i) && "Value should match after transform");
+        }
+        
+        // 转换到64位
+        RBTreeArray64<int, string> targetTree64;
+        bool success64 = targetTree64.Transform(targetTree32);
+        assert(success64 && "Transform to 64-bit should succeed");
+        
+        // 验证数据
+        for (int i = 0; i < 100; ++i) {
+            string value;
+            bool found = targetTree64.Search(i, value);
+            assert(found && "Key should be found after transform");
+            assert(value == "value_" + to_string(i) && "Value should match after transform");
+        }
+        
+        cout << "Transform test passed!" << endl;
+    }
+    
+    // 边界条件测试
+    template<typename RBTreeType>
+    void testEdgeCases() {
+        cout << "Testing edge cases..." << endl;
+        
+        RBTreeType tree;
+        
+        // 空树操作
+        int key, value;
+        assert(!tree.GetMin(key, value) && "GetMin should fail on empty tree");
+        assert(!tree.GetMax(key, value) && "GetMax should fail on empty tree");
+        assert(!tree.Delete(1) && "Delete should fail on empty tree");
+        
+        // 单个元素
+        tree.Insert(1, 100);
+        assert(tree.GetMin(key, value) && key == 1 && value == 100);
+        assert(tree.GetMax(key, value) && key == 1 && value == 100);
+        
+        // 重复插入
+        tree.Insert(1, 200);
+        tree.Search(1, value);
+        assert(value == 200 && "Value should be updated on duplicate insert");
+        
+        // 删除唯一元素
+        assert(tree.Delete(1) && "Delete should succeed");
+        assert(!tree.Search(1, value) && "Search should fail after deletion");
+        
+        cout << "Edge cases test passed!" << endl;
+    }
+    
+    // 运行所有测试
+    void runAllTests() {
+        cout << "=== Testing RBTreeArray16 ===" << endl;
+        testBasicOperations<RBTreeArray16<int, string>>();
+        testDeletion<RBTreeArray16<int, int>>();
+        testPerformance<RBTreeArray16<int, int>>();
+        testEdgeCases<RBTreeArray16<int, int>>();
+        
+        cout << "\n=== Testing RBTreeArray32 ===" << endl;
+        testBasicOperations<RBTreeArray32<int, string>>();
+        testDeletion<RBTreeArray32<int, int>>();
+        testPerformance<RBTreeArray32<int, int>>();
+        testEdgeCases<RBTreeArray32<int, int>>();
+        
+        cout << "\n=== Testing RBTreeArray64 ===" << endl;
+        testBasicOperations<RBTreeArray64<int, string>>();
+        testDeletion<RBTreeArray64<int, int>>();
+        testPerformance<RBTreeArray64<int, int>>();
+        testEdgeCases<RBTreeArray64<int, int>>();
+        
+        cout << "\n=== Testing Transform ===" << endl;
+        testTransform();
+        
+        cout << "\n=== All tests passed! ===" << endl;
+    }
+};
+
+#include <functional>
+
+template<typename Iterator>
+std::function<void(Iterator&)>IteratorNext(){
+    return [](Iterator& iterator){iterator++;};
+}
+
+template<typename Iterator>
+std::function<void(Iterator&)>IteratorPrivious(){
+    return [](Iterator& iterator){iterator--;};
+}
+
+void IteratorTest(){
+    const unsigned size=20;
+    PCG32Struct PCG32Status;
+    PCG32SetSeed(&PCG32Status,time(NULL));
+    RBTreeArray16<unsigned,std::string> tree16;
+    std::map<unsigned,std::string> map16;
+    for(unsigned index=0;index<size;index=index+1){
+        tree16.Insert(index,std::to_string(index));
+        map16[index]=std::to_string(index);
+    }
+    if(true){
+        for(auto iterator=map16.begin();iterator!=map16.end();iterator++){
+            printf("%u, %s\n",iterator->first,iterator->second.c_str());
+        }
+        for(auto iterator=tree16.begin();iterator!=tree16.end();iterator++){
+            printf("%u, %s\n",iterator.Key(),iterator.Value().c_str());
+        }
+    }
+    if(true){
+        printf("===============\n");
+        auto iterator=tree16.end();
+        while(true){
+            iterator--;
+            printf("%u, %s\n",iterator.Key(),iterator.Value().c_str());
+            if(iterator==tree16.begin()){
+                break;
+            }
+        }
+    }
+    if(true){
+        printf("===============\n");
+        auto iterator=tree16.begin();
+        std::function<void(RBTreeArray16<unsigned,std::string>::UnorderedIterator&)> Operation=IteratorNext<RBTreeArray16<unsigned,std::string>::UnorderedIterator>();
+        unsigned count=0;
+        while(count<100){
+            printf("%u, %s\n",iterator.Key(),iterator.Value().c_str());
+            Operation(iterator);
+            count=count+1;
+            if(iterator==tree16.end()){
+                Operation=IteratorPrivious<RBTreeArray16<unsigned,std::string>::UnorderedIterator>();
+                Operation(iterator);
+                continue;
+            }
+            if(iterator==tree16.begin()){
+                printf("%u, %s\n",iterator.Key(),iterator.Value().c_str());
+                Operation(iterator);
+                Operation=IteratorNext<RBTreeArray16<unsigned,std::string>::UnorderedIterator>();
+                Operation(iterator);
+            }
+        }
+    }
+    if(true){
+        RBTreeArray64<unsigned,std::string> tree64;
+        for(auto iterator=tree64.begin();iterator!=tree64.end();iterator++){
+            printf("EMPTY TREE\n!");
+        }
+    }
+    if(true){
+        RBTreeArray64<unsigned,double> tree64={{1,2},{3,4},{5,6}};
+        for(auto iterator=tree64.begin();iterator!=tree64.end();iterator++){
+            printf("%u, %lf\n",iterator.Key(),iterator.Value());
+        }
+    }
+    if(true){
+        RBTreeArray64<unsigned,double> tree64={{1,2},{3,4},{5,6}};
+        for(unsigned index=0;index<64;index=index+1){
+            const double pi=3.1415926535897932384626433832795;
+            tree64[index]=index*pi;
+        }
+        for(auto iterator=tree64.UnorderedBegin();iterator!=tree64.UnorderedEnd();iterator++){
+            printf("%u, %lf\n",iterator.Key(),iterator.Value());
+        }
+    }
+}
+
+static inline bool IfDelete_10Outof1(unsigned key,unsigned value){
+    // return false;
+    // return key%101==0;
+    // return true;
+    // return key%2==0;
+    // return key%4==0;
+    return key%10==0;
+}
+
+static inline bool IfDelete(unsigned key,unsigned value){
+    // return false;
+    // return key%101==0;
+    // return true;
+    // return key%2==0;
+    // return key%4==0;
+    return key%3==0;
+}
+
+static inline bool IfDeleteRandom(const std::string& key,const std::vector<std::string>& value,PCG32Struct* PCGStatus){
+    return stoi(key)%11==0;
+    return true;
+    return PCG32Uniform_Strict(PCGStatus,0,10)<0;
+}
+
+template<typename RBTreeArray,typename Map>
+bool NodeCompare(const RBTreeArray& tree,const Map& map){
+    if(tree.KeyCount()!=map.size()){
+        return false;
+    }
+    auto OrderedIterator=tree.OrderedBegin();
+    auto mapIterator=map.begin();
+    while(OrderedIterator!=tree.OrderedEnd()){
+        if(OrderedIterator.Key()!=mapIterator->first){
+            return false;
+        }
+        ++mapIterator;
+        ++OrderedIterator;
+    }
+    return true;
+}
+
+#include <sys/time.h>
+
+template<typename RBTreeArray,typename Map>
+void SpeedTestTemplate(RBTreeArray& tree,Map& map,const long long unsigned int Case){
+
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+
+    unsigned* keys=(unsigned*)malloc(sizeof(unsigned)*Case);
+    unsigned* UnorderedKeysCopy=(unsigned*)malloc(sizeof(unsigned)*Case);
+    for(long long unsigned int index=0;index<Case;index=index+1){
+        keys[index]=PCG32(&PCGStatus);
+    }
+    memcpy(UnorderedKeysCopy,(const unsigned*)keys,sizeof(unsigned)*Case);
+    PCG32UniformShuffle(&PCGStatus,UnorderedKeysCopy,Case);
+
+    struct timeval start,end;
+    unsigned millisecondsRBTreeArray=0;
+    unsigned millisecondsStdmap=0;
+
+    gettimeofday(&start,NULL);
+    for(long long unsigned int index=0;index<Case;index=index+1){
+        tree.Insert(keys[index],index);
+    }
+    gettimeofday(&end,NULL);
+    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+    
+    gettimeofday(&start,NULL);
+    for(long long unsigned int index=0;index<Case;index=index+1){
+        map[keys[index]]=index;
+    }
+    gettimeofday(&end,NULL);
+    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    if(!NodeCompare(tree,map)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    printf("  Insert: RBTreeArray%u<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",tree.GetBitLength(),millisecondsRBTreeArray,millisecondsStdmap);
+
+    RBTree* treeCopy=(RBTree*)malloc(tree.ByteSize());
+    memcpy(treeCopy,(const RBTree*)tree.Data(),tree.ByteSize());
+
+    gettimeofday(&start,NULL);
+    unsigned valueRBTreeArray;
+    for(long long unsigned int index=0;index<Case;index=index+1){
+        tree.Search(UnorderedKeysCopy[index],valueRBTreeArray);
+    }
+    gettimeofday(&end,NULL);
+    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    gettimeofday(&start,NULL);
+    unsigned valueStdmap;
+    for(long long unsigned int index=0;index<Case;index=index+1){
+        valueStdmap=map.at(UnorderedKeysCopy[index]);
+    }
+    gettimeofday(&end,NULL);
+    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    if(valueRBTreeArray!=valueStdmap){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    if(!NodeCompare(tree,map)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    printf("  Search: RBTreeArray%u<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",tree.GetBitLength(),millisecondsRBTreeArray,millisecondsStdmap);
+
+    long long unsigned int sum[2]={0LLU};
+    gettimeofday(&start,NULL);
+    for(auto iterator=tree.UnorderedBegin();iterator!=tree.UnorderedEnd();++iterator){
+        sum[0]=sum[0]+iterator.Key();
+    }
+    gettimeofday(&end,NULL);
+    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    gettimeofday(&start,NULL);
+    for(auto iterator=map.begin();iterator!=map.end();++iterator){
+        sum[1]=sum[1]+iterator->first;
+    }
+    gettimeofday(&end,NULL);
+    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    if(sum[0]!=sum[1]){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    if(!NodeCompare(tree,map)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    printf("  Loop Through: RBTreeArray%u<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",tree.GetBitLength(),millisecondsRBTreeArray,millisecondsStdmap);
+
+    gettimeofday(&start,NULL);
+    for(long long unsigned int index=0;index<Case;index=index+1){
+        tree.Delete(UnorderedKeysCopy[index]);
+    }
+    gettimeofday(&end,NULL);
+    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    gettimeofday(&start,NULL);
+    for(long long unsigned int index=0;index<Case;index=index+1){
+        map.erase(UnorderedKeysCopy[index]);
+    }
+    gettimeofday(&end,NULL);
+    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    if(!NodeCompare(tree,map)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    printf("  Delete: RBTreeArray%u<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",tree.GetBitLength(),millisecondsRBTreeArray,millisecondsStdmap);
+
+    tree.SetTree(treeCopy);
+    for(long long unsigned int index=0;index<Case;index=index+1){
+        map[keys[index]]=index;
+    }
+    if(!NodeCompare(tree,map)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    auto iteratorArray=tree.OrderedBegin();
+    for(auto iterator=map.begin();iterator!=map.end();iterator++){
+        if(iteratorArray.Key()!=iterator->first){
+            printf("%u, %u\n",iteratorArray.Key(),iterator->first);
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        iteratorArray++;
+    }
+    if(iteratorArray!=tree.OrderedEnd()){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    gettimeofday(&start,NULL);
+    unsigned deleted=tree.ConditionalDelete(IfDelete);
+    gettimeofday(&end,NULL);
+    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    gettimeofday(&start,NULL);
+    for(auto iterator=map.begin();iterator!=map.end();){
+        if(IfDelete(iterator->first,iterator->second)){
+            iterator=map.erase(iterator);
+        }else{
+            ++iterator;
+        }
+    }
+    gettimeofday(&end,NULL);
+    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    if(!NodeCompare(tree,map)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    printf("  Conditional Delete 1/3 keys: RBTreeArray%u<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",tree.GetBitLength(),millisecondsRBTreeArray,millisecondsStdmap);
+
+    for(long long unsigned int index=0;index<Case;index=index+1){
+        tree[keys[index]]=index;
+        map[keys[index]]=index;
+    }
+    if(!NodeCompare(tree,map)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    gettimeofday(&start,NULL);
+    {
+        unsigned deleted=tree.ConditionalDelete(IfDelete_10Outof1);
+    }
+    gettimeofday(&end,NULL);
+
+    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+    gettimeofday(&start,NULL);
+    for(auto iterator=map.begin();iterator!=map.end();){
+        if(IfDelete_10Outof1(iterator->first,iterator->second)){
+            iterator=map.erase(iterator);
+        }else{
+            ++iterator;
+        }
+    }
+    gettimeofday(&end,NULL);
+    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    if(!NodeCompare(tree,map)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("  Conditional Delete 1/10 keys: RBTreeArray%u<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",tree.GetBitLength(),millisecondsRBTreeArray,millisecondsStdmap);
+
+}
+
+void SpecialSpeed16(){
+    constexpr unsigned scale=128;
+    RBTreeArray16<unsigned,unsigned> trees[scale];
+    std::map<unsigned,unsigned> maps[scale];
+    for(unsigned index=0;index<scale;index=index+1){
+        trees[index].ReSize(65535);
+    }
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+
+    unsigned keys[65535];
+    unsigned UnorderedKeysCopy[65535];
+    for(long long unsigned int index=0;index<65535;index=index+1){
+        keys[index]=PCG32(&PCGStatus);
+    }
+    memcpy(UnorderedKeysCopy,(const unsigned*)keys,sizeof(unsigned)*65535);
+    PCG32UniformShuffle(&PCGStatus,UnorderedKeysCopy,65535);
+
+    struct timeval start,end;
+    unsigned millisecondsRBTreeArray=0;
+    unsigned millisecondsStdmap=0;
+
+    gettimeofday(&start,NULL);
+    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
+        for(unsigned index=0;index<65535;index=index+1){
+            trees[indexTree].Insert(keys[index],index);
+        }
+    }
+    gettimeofday(&end,NULL);
+    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    gettimeofday(&start,NULL);
+    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
+        for(unsigned index=0;index<65535;index=index+1){
+            maps[indexTree][keys[index]]=index;
+        }
+    }
+    gettimeofday(&end,NULL);
+    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    printf("  Insert: RBTreeArray16<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",millisecondsRBTreeArray,millisecondsStdmap);
+
+    gettimeofday(&start,NULL);
+    long long unsigned int searchSum[2]={0};
+    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
+        for(unsigned index=0;index<65535;index=index+1){
+            unsigned search;
+            trees[indexTree].Search(UnorderedKeysCopy[index],search);
+            searchSum[0]=searchSum[0]+search;
+        }
+    }
+    gettimeofday(&end,NULL);
+    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    gettimeofday(&start,NULL);
+    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
+        for(unsigned index=0;index<65535;index=index+1){
+            unsigned valueStdmap=maps[indexTree].at(UnorderedKeysCopy[index]);
+            searchSum[1]=searchSum[1]+valueStdmap;
+        }
+    }
+    gettimeofday(&end,NULL);
+    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    if(searchSum[0]!=searchSum[1]){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    printf("  Search: RBTreeArray16<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",millisecondsRBTreeArray,millisecondsStdmap);
+
+    long long unsigned int sum[2]={0LLU};
+    gettimeofday(&start,NULL);
+    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
+        for(auto iterator=trees[indexTree].UnorderedBegin();iterator!=trees[indexTree].UnorderedEnd();++iterator){
+            sum[0]=sum[0]+iterator.Key();
+        }
+    }
+    gettimeofday(&end,NULL);
+    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    gettimeofday(&start,NULL);
+    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
+        for(auto iterator=maps[indexTree].begin();iterator!=maps[indexTree].end();++iterator){
+            sum[1]=sum[1]+iterator->first;
+        }
+    }
+    gettimeofday(&end,NULL);
+    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    if(sum[0]!=sum[1]){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    printf("  Loop Through: RBTreeArray16<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",millisecondsRBTreeArray,millisecondsStdmap);
+
+    gettimeofday(&start,NULL);
+    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
+        for(long long unsigned int index=0;index<65535;index=index+1){
+            trees[indexTree].Delete(UnorderedKeysCopy[index]);
+        }
+    }
+    gettimeofday(&end,NULL);
+    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    gettimeofday(&start,NULL);
+    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
+        for(long long unsigned int index=0;index<65535;index=index+1){
+            maps[indexTree].erase(UnorderedKeysCopy[index]);
+        }
+    }
+    gettimeofday(&end,NULL);
+    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    printf("  Delete: RBTreeArray16<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",millisecondsRBTreeArray,millisecondsStdmap);
+
+    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
+        for(unsigned index=0;index<65535;index=index+1){
+            trees[indexTree].Insert(keys[index],index);
+            maps[indexTree][keys[index]]=index;
+        }
+    }
+
+    gettimeofday(&start,NULL);
+    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
+        unsigned deleted=trees[indexTree].ConditionalDelete(IfDelete);
+    }
+    gettimeofday(&end,NULL);
+    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    gettimeofday(&start,NULL);
+    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
+        for(auto iterator=maps[indexTree].begin();iterator!=maps[indexTree].end();){
+            if(IfDelete(iterator->first,iterator->second)){
+                iterator=maps[indexTree].erase(iterator);
+            }else{
+                ++iterator;
+            }
+        }
+    }
+    gettimeofday(&end,NULL);
+    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    printf("  Conditional Delete 1/3 keys: RBTreeArray16<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",millisecondsRBTreeArray,millisecondsStdmap);
+
+    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
+        for(unsigned index=0;index<65535;index=index+1){
+            trees[indexTree].Insert(keys[index],index);
+            maps[indexTree][keys[index]]=index;
+        }
+    }
+
+    gettimeofday(&start,NULL);
+    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
+        unsigned deleted=trees[indexTree].ConditionalDelete(IfDelete_10Outof1);
+    }
+    gettimeofday(&end,NULL);
+    millisecondsRBTreeArray=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    gettimeofday(&start,NULL);
+    for(unsigned indexTree=0;indexTree<scale;indexTree=indexTree+1){
+        for(auto iterator=maps[indexTree].begin();iterator!=maps[indexTree].end();){
+            if(IfDelete_10Outof1(iterator->first,iterator->second)){
+                iterator=maps[indexTree].erase(iterator);
+            }else{
+                ++iterator;
+            }
+        }
+    }
+    gettimeofday(&end,NULL);
+    millisecondsStdmap=(end.tv_sec-start.tv_sec)*1000+(end.tv_usec-start.tv_usec)/1000.0+0.5;
+
+    printf("  Conditional Delete 1/10 keys: RBTreeArray16<unsigned,unsigned>: %u , std::map<unsigned,unsigned>: %u milliseconds\n",millisecondsRBTreeArray,millisecondsStdmap);
+}
+
+void SpeedTest(){
+    long long unsigned int Case=1234567*2LLU;
+    if(false){
+        printf("RBTreeArray16:\n");
+        RBTreeArray16<unsigned,unsigned> tree16;
+        std::map<unsigned,unsigned> map;
+        SpeedTestTemplate(tree16,map,65535);
+    }else{
+        printf("RBTreeArray16:\n");
+        SpecialSpeed16();
+    }
+    if(true){
+        printf("RBTreeArray32:\n");
+        RBTreeArray32<unsigned,unsigned> tree32;
+        std::map<unsigned,unsigned> map;
+        SpeedTestTemplate(tree32,map,Case);
+    }
+    if(true){
+        printf("RBTreeArray64:\n");
+        RBTreeArray64<unsigned,unsigned> tree64;
+        std::map<unsigned,unsigned> map;
+        SpeedTestTemplate(tree64,map,Case);
+    }
+}
+
+void BoundaryTest(){
+    if(true){
+        PCG32Struct PCGStatus;
+        PCG32SetSeed(&PCGStatus,time(NULL));
+        unsigned length=PCG32Uniform_Strict(&PCGStatus,10000,50000);
+
+        RBTreeArray64<std::string,std::pair<double,std::vector<std::string>>> tree={{"3.1415926",{3.1415926,{"3",".","1","4"}}}};
+        for(unsigned index=0;index<length;index=index+1){
+            std::string key=std::to_string(PCG32Uniform_Strict(&PCGStatus,100000,200000));
+            std::vector<std::string> vector;
+            for(const char c:key){
+                vector.push_back({c});
+            }
+            tree[key]={PCG32UniformReal(&PCGStatus,0,1),vector};
+        }
+        unsigned treeSize=tree.KeyCount();
+        RBTreeArray64<std::string,std::pair<double,std::vector<std::string>>> treeCopy=tree;
+        if(treeCopy.KeyCount()!=tree.KeyCount()||tree.KeyCount()!=treeSize){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        RBTreeArray64<std::string,std::pair<double,std::vector<std::string>>> treeMove=std::move(tree);
+        if(tree.KeyCount()!=0||treeMove.KeyCount()!=treeSize){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    if(true){
+        RBTreeArray16<unsigned,unsigned> tree16;
+        tree16.ConditionalDelete([](const unsigned key,unsigned value){return (bool)(key&1);});
+        tree16[1]=1;
+        tree16.ConditionalDelete([](const unsigned key,unsigned value){return (bool)(key&1);});
+        tree16.ConditionalDelete([](const unsigned key,unsigned value){return (bool)(key&1);});
+        tree16.Delete(0);
+        tree16.Delete(1);
+        unsigned search;
+        tree16.Search(1,search);
+        RBTreeArray32<unsigned,unsigned> tree32;
+        tree32.Transform(tree16);
+        tree16.Transform(tree32);
+        tree16[1]=1;
+        tree32.Transform(tree16);
+        search=0;
+        tree32.Search(1,search);
+        if(search!=1){
+            throw std::logic_error("RBTreeArray error");
+        }
+        // tree16=tree32;
+    }
+    if(true){
+        PCG32Struct PCGStatus;
+        PCG32SetSeed(&PCGStatus,time(NULL));
+
+        RBTreeArray16<std::string,std::vector<std::string>> tree16={{"Hellor",{"H","e","l","l","o"}}};
+        std::string string="World!";
+        
+        for(unsigned index=0;index<10;index=index+1){
+            std::vector<std::string> vector;
+            for(const char c:string){
+                vector.push_back({c});
+            }
+            tree16.Insert(string,vector);
+            string=std::to_string(PCG32Uniform(&PCGStatus,0,999));
+        }
+        for(auto iterator=tree16.UnorderedBegin();iterator!=tree16.UnorderedEnd();iterator++){
+            std::cout<<iterator.Key()<<": ";
+            for(const auto iteratorVector:iterator.Value()){
+                std::cout<<iteratorVector<<", ";
+            }
+            printf("\n");
+        }
+        RBTreeArray32<std::string,std::vector<std::string>> tree32;
+        tree32.Transform(tree16);
+        for(auto iterator=tree32.UnorderedBegin();iterator!=tree32.UnorderedEnd();iterator++){
+            std::cout<<iterator.Key()<<": ";
+            for(const auto iteratorVector:iterator.Value()){
+                std::cout<<iteratorVector<<", ";
+            }
+            printf("\n");
+        }
+        RBTreeArray32<std::string,std::vector<std::string>> tree32Copy;
+        tree32Copy=tree32;
+    }
+    if(true){
+        RBTreeArray32<unsigned,double> tree32={{1,2},{3,4},{5,6}};
+        for(const auto& [key,value]:tree32){
+            printf("%u,%lf\n",key,value);
+        }
+    }
+    if(true){
+        PCG32Struct PCGStatus;
+        PCG32SetSeed(&PCGStatus,time(NULL));
+        std::map<std::string,std::vector<std::string>> map;
+        RBTreeArray32<std::string,std::vector<std::string>> tree;
+        unsigned length=PCG32Uniform_Strict(&PCGStatus,10000,50000);
+        for(unsigned index=0;index<length;index=index+1){
+            std::string key=std::to_string(PCG32Uniform_Strict(&PCGStatus,100000,200000));
+            std::vector<std::string> vector;
+            for(const char c:key){
+                vector.push_back({c});
+            }
+            map[key]=vector;
+            tree[key]=vector;
+        }
+        if(!NodeCompare(tree,map)){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        RBTreeArray32<std::string,std::vector<std::string>> trees[10];
+        trees[0]=std::move(tree);
+        tree.Insert("test",{"0","1","2","3"});
+        for(unsigned index=1;index<10;index=index+1){
+            trees[index]=trees[index-1];
+        }
+        if(!NodeCompare(trees[9],map)){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    printf("BoundaryTest passed\n========================\n");
+}
+
+void SpecialTestConditionalDelete(){
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,123456789);
+
+    RBTreeArray32<unsigned,unsigned> treeBase;
+    RBTreeArray32<unsigned,unsigned> tree;
+    std::map<unsigned,unsigned> mapBase;
+    std::map<unsigned,unsigned> map;
+
+    long long unsigned int Case=1<<20;
+    unsigned* keys=(unsigned*)malloc(sizeof(unsigned)*Case);
+    for(long long unsigned int index=0;index<Case;index=index+1){
+        keys[index]=PCG32(&PCGStatus);
+    }
+
+    for(long long unsigned int index=0;index<Case;index=index+1){
+        treeBase[keys[index]]=index;
+        mapBase[keys[index]]=index;
+    }
+
+    RBTree* treeCopy=(RBTree*)malloc(treeBase.ByteSize());
+    memcpy(treeCopy,treeBase.Data(),treeBase.ByteSize());
+    long long unsigned int deleted;
+    long long unsigned int mapDelete;
+    if(false){
+        map=mapBase;
+        tree.SetTree(treeCopy);
+        deleted=tree.ConditionalDelete(IfDelete);
+        mapDelete=map.size();
+        for(auto iterator=map.begin();iterator!=map.end();){
+            if(IfDelete(iterator->first,iterator->second)){
+                iterator=map.erase(iterator);
+            }else{
+                ++iterator;
+            }
+        }
+        mapDelete=mapDelete-map.size();
+        if(tree.KeyCount()!=map.size()){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    if(true){
+        std::map<std::string,std::vector<std::string>> map;
+        RBTreeArray32<std::string,std::vector<std::string>> tree;
+        unsigned length=PCG32Uniform_Strict(&PCGStatus,10000,50000);
+        for(unsigned index=0;index<length;index=index+1){
+            std::string key=std::to_string(PCG32Uniform_Strict(&PCGStatus,100000,200000));
+            std::vector<std::string> vector;
+            for(const char c:key){
+                vector.push_back({c});
+            }
+            map[key]=vector;
+            tree[key]=vector;
+        }
+        mapDelete=map.size();
+        PCG32Struct PCGStatus0,PCGStatus1;
+        PCG32SetSeed(&PCGStatus0,1234567);
+        PCG32SetSeed(&PCGStatus1,1234567);
+        deleted=tree.ConditionalDelete(IfDeleteRandom,&PCGStatus0);
+        for(auto iterator=map.begin();iterator!=map.end();){
+            if(IfDeleteRandom(iterator->first,iterator->second,&PCGStatus1)){
+                iterator=map.erase(iterator);
+            }else{
+                ++iterator;
+            }
+        }
+        mapDelete=mapDelete-map.size();
+        if(tree.KeyCount()!=map.size()){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        if(!NodeCompare(tree,map)){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    // each strategy calls the condition once per node, and a forwarded parameter is not moved from between calls
+    for(unsigned percent:{10,40,80}){
+        RBTreeArray32<unsigned,unsigned> treeOnce;
+        std::map<unsigned,unsigned> mapOnce;
+        for(unsigned index=0;index<20000;index=index+1){
+            unsigned key=PCG32(&PCGStatus);
+            treeOnce[key]=index;
+            mapOnce[key]=index;
+        }
+        uint64_t calls=0;
+        uint64_t keyCount=treeOnce.KeyCount();
+        auto condition=[](unsigned key,unsigned value,uint64_t* calls,std::string tag,unsigned percent){
+            *calls=*calls+1;
+            return tag=="a tag that is too long for the short string buffer"&&key%100<percent;
+        };
+        deleted=treeOnce.ConditionalDelete(condition,&calls,std::string("a tag that is too long for the short string buffer"),percent);
+        for(auto iterator=mapOnce.begin();iterator!=mapOnce.end();){
+            if(iterator->first%100<percent){
+                iterator=mapOnce.erase(iterator);
+            }else{
+                ++iterator;
+            }
+        }
+        if(calls!=keyCount||deleted!=keyCount-mapOnce.size()||!NodeCompare(treeOnce,mapOnce)){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    free(keys);
+}
+
+template<typename SecondaryIndex,typename Map>
+bool SecondaryIndexCompare(const SecondaryIndex& index,const Map& map,unsigned groups){
+    uint64_t total=0;
+    for(unsigned group=0;group<groups;group=group+1){
+        uint64_t count=0;
+        for(const auto& pair:map){
+            if(pair.second.first==group){
+                count=count+1;
+            }
+        }
+        bool matched=true;
+        uint64_t visited=index.ForEach(group,[&](const unsigned& key,const std::pair<unsigned,double>& value){
+            auto iterator=map.find(key);
+            if(iterator==map.end()||iterator->second!=value||value.first!=group){
+                matched=false;
+            }
+        });
+        if(!matched||visited!=count||index.Count(group)!=count){
+            return false;
+        }
+        total=total+count;
+    }
+    return total==map.size()&&index.KeyCount()==map.size();
+}
+
+void SecondaryIndexTest(){
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+    const unsigned groups=37;
+
+    RBTreeArray32<unsigned,std::pair<unsigned,double>> tree;
+    std::map<unsigned,std::pair<unsigned,double>> map;
+    auto Group=[](const std::pair<unsigned,double>& value){return value.first;};
+    RBTreeArraySecondaryIndex<RBTreeArray32<unsigned,std::pair<unsigned,double>>,decltype(Group)> byGroup(tree,Group);
+
+    for(unsigned round=0;round<200000;round=round+1){
+        unsigned key=PCG32Uniform(&PCGStatus,0,20000);
+        unsigned operation=PCG32Uniform(&PCGStatus,0,2);
+        if(operation==0){
+            tree.Delete(key);
+            map.erase(key);
+        }else{
+            std::pair<unsigned,double> value(PCG32Uniform(&PCGStatus,0,groups-1),PCG32UniformReal(&PCGStatus,0,1));
+            tree.Insert(key,value);
+            map[key]=value;
+        }
+    }
+    if(!SecondaryIndexCompare(byGroup,map,groups)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    tree.ConditionalDelete([](const unsigned key,const std::pair<unsigned,double>& value){return key%3==0;});
+    for(auto iterator=map.begin();iterator!=map.end();){
+        if(iterator->first%3==0){
+            iterator=map.erase(iterator);
+        }else{
+            ++iterator;
+        }
+    }
+    if(!SecondaryIndexCompare(byGroup,map,groups)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    unsigned key;
+    std::pair<unsigned,double> value;
+    if(byGroup.Search(groups,key,value)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    std::vector<char> block(tree.ByteSizeWithIndexes());
+    tree.WriteWithIndexes(block.data());
+    RBTreeArray32<unsigned,std::pair<unsigned,double>> treeLoaded;
+    RBTreeArraySecondaryIndex<RBTreeArray32<unsigned,std::pair<unsigned,double>>,decltype(Group)> byGroupLoaded(treeLoaded,Group);
+    if(!treeLoaded.ReadWithIndexes(block.data(),block.size())||!NodeCompare(treeLoaded,map)||!SecondaryIndexCompare(byGroupLoaded,map,groups)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    // links past nodeCount in the tree or an index, and index entries naming a missing primary node, are rejected
+    {
+        RBTree* indexBlock=(RBTree*)(block.data()+tree.ByteSize());
+        const uint64_t nodeSize=(byGroup.ByteSize()-sizeof(RBTree))/indexBlock->size;
+        uint32_t* indexRoot=(uint32_t*)(indexBlock->nodes+nodeSize*indexBlock->rootIndex);
+        const uint32_t left=indexRoot[1];
+        indexRoot[1]=0x7FFFFFF0;
+        if(treeLoaded.ReadWithIndexes(block.data(),block.size())||!SecondaryIndexCompare(byGroupLoaded,map,groups)){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        indexRoot[1]=left;
+        uint32_t* primaryIndex=(uint32_t*)(indexBlock->nodes+nodeSize*indexBlock->rootIndex+sizeof(uint32_t)*5);
+        const uint32_t primaryIndexSaved=*primaryIndex;
+        *primaryIndex=(uint32_t)indexBlock->nodeCount;
+        if(treeLoaded.ReadWithIndexes(block.data(),block.size())||!SecondaryIndexCompare(byGroupLoaded,map,groups)){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        *primaryIndex=primaryIndexSaved;
+        RBTree* primaryBlock=(RBTree*)block.data();
+        const uint64_t rootIndex=primaryBlock->rootIndex;
+        primaryBlock->rootIndex=primaryBlock->nodeCount;
+        if(treeLoaded.ReadWithIndexes(block.data(),block.size())){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        primaryBlock->rootIndex=rootIndex;
+        if(!treeLoaded.ReadWithIndexes(block.data(),block.size())||!NodeCompare(treeLoaded,map)||!SecondaryIndexCompare(byGroupLoaded,map,groups)){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    // an index projecting to std::string works in memory but is not written
+    {
+        RBTreeArray32<unsigned,std::pair<unsigned,double>> treeNamed={{1,{2,0.5}}};
+        auto Name=[](const std::pair<unsigned,double>& value){return std::to_string(value.first);};
+        RBTreeArraySecondaryIndex<RBTreeArray32<unsigned,std::pair<unsigned,double>>,decltype(Name)> byName(treeNamed,Name);
+        std::vector<char> blockNamed(treeNamed.ByteSizeWithIndexes());
+        if(byName.Count("2")!=1||treeNamed.WriteWithIndexes(blockNamed.data())){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+
+    // the indexes follow a moved tree, the moved-from tree has none left
+    RBTreeArray32<unsigned,std::pair<unsigned,double>> moved(std::move(tree));
+    tree.Insert(1,std::pair<unsigned,double>(0,0.5));
+    moved.Insert(20001,std::pair<unsigned,double>(1,0.5));
+    map[20001]=std::pair<unsigned,double>(1,0.5);
+    if(!SecondaryIndexCompare(byGroup,map,groups)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    treeLoaded=std::move(moved);
+    moved.Insert(2,std::pair<unsigned,double>(0,0.5));
+    treeLoaded.Insert(20002,std::pair<unsigned,double>(2,0.5));
+    map[20002]=std::pair<unsigned,double>(2,0.5);
+    if(!SecondaryIndexCompare(byGroup,map,groups)||!SecondaryIndexCompare(byGroupLoaded,map,groups)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    tree=std::move(treeLoaded);
+
+    tree.Clear();
+    if(byGroup.KeyCount()!=0||byGroupLoaded.KeyCount()!=0){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("SecondaryIndexTest passed\n========================\n");
+}
+
+void PrefixRangeTest(){
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+
+    RBTreeArray32<std::string,unsigned> tree;
+    std::map<std::string,unsigned> map;
+    for(unsigned index=0;index<20000;index=index+1){
+        std::string key=std::to_string(PCG32Uniform(&PCGStatus,0,99999));
+        tree.Insert(key,index);
+        map[key]=index;
+    }
+    const char* prefixes[]={"","1","12","123","99999","999990","a","0"};
+    for(const char* prefix:prefixes){
+        std::string prefixString(prefix);
+        auto range=tree.PrefixRange(prefixString);
+        auto mapIterator=map.lower_bound(prefixString);
+        for(auto iterator=range.begin();iterator!=range.end();++iterator){
+            if(mapIterator==map.end()||iterator.Key()!=mapIterator->first||iterator.Value()!=mapIterator->second){
+                char errorMassage[1024];
+                sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+                throw std::logic_error(errorMassage);
+            }
+            ++mapIterator;
+        }
+        if(mapIterator!=map.end()&&mapIterator->first.compare(0,prefixString.size(),prefixString)==0){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+
+    RBTreeArray16<std::tuple<unsigned,unsigned,unsigned>,unsigned> tupleTree;
+    std::map<std::tuple<unsigned,unsigned,unsigned>,unsigned> tupleMap;
+    for(unsigned index=0;index<30000;index=index+1){
+        std::tuple<unsigned,unsigned,unsigned> key(PCG32Uniform(&PCGStatus,0,9),PCG32Uniform(&PCGStatus,0,9),PCG32Uniform(&PCGStatus,0,99));
+        tupleTree.Insert(key,index);
+        tupleMap[key]=index;
+    }
+    for(unsigned first=0;first<11;first=first+1){
+        uint64_t count=0;
+        for(const auto& pair:tupleMap){
+            count=count+(std::get<0>(pair.first)==first);
+        }
+        if(tupleTree.PrefixRange<1>(std::make_tuple(first)).Count()!=count){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        for(unsigned second=0;second<10;second=second+1){
+            auto mapIterator=tupleMap.lower_bound(std::make_tuple(first,second,0u));
+            for(const auto& [key,value]:tupleTree.PrefixRange<2>(std::make_tuple(first,second))){
+                if(mapIterator==tupleMap.end()||key!=mapIterator->first||value!=mapIterator->second){
+                    char errorMassage[1024];
+                    sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+                    throw std::logic_error(errorMassage);
+                }
+                ++mapIterator;
+            }
+            if(mapIterator!=tupleMap.end()&&std::get<0>(mapIterator->first)==first&&std::get<1>(mapIterator->first)==second){
+                char errorMassage[1024];
+                sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+                throw std::logic_error(errorMassage);
+            }
+        }
+    }
+
+    RBTreeArray64<std::pair<unsigned,double>,unsigned> pairTree={{{1,0.5},1},{{2,0.5},2},{{2,1.5},3},{{3,0.5},4}};
+    if(pairTree.PrefixRange<1>(std::make_tuple(2u)).Count()!=2||!pairTree.PrefixRange<1>(std::make_tuple(4u)).IsEmpty()){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("PrefixRangeTest passed\n========================\n");
+}
+
+void NearestTest(){
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+
+    RBTreeArray32<long long,unsigned> tree;
+    std::map<long long,unsigned> map;
+    for(unsigned index=0;index<5000;index=index+1){
+        long long key=PCG32Uniform(&PCGStatus,0,100000);
+        tree.Insert(key,index);
+        map[key]=index;
+    }
+    for(unsigned round=0;round<2000;round=round+1){
+        long long probe=(long long)PCG32Uniform(&PCGStatus,0,100002)-1;
+        auto neighbors=tree.Neighbors(probe);
+        auto ceiling=map.lower_bound(probe);
+        auto floor=map.upper_bound(probe);
+        bool floorExist=floor!=map.begin();
+        if(floorExist){
+            --floor;
+        }
+        if((neighbors.first!=tree.OrderedEnd())!=floorExist||(floorExist&&neighbors.first.Key()!=floor->first)
+            ||(neighbors.second!=tree.OrderedEnd())!=(ceiling!=map.end())||(ceiling!=map.end()&&neighbors.second.Key()!=ceiling->first)){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+
+        unsigned k=PCG32Uniform(&PCGStatus,0,40);
+        std::vector<std::pair<long long,unsigned>> nearest=tree.Nearest(probe,k);
+        std::vector<long long> distances;
+        for(const auto& pair:map){
+            distances.push_back(pair.first>probe?pair.first-probe:probe-pair.first);
+        }
+        std::sort(distances.begin(),distances.end());
+        if(nearest.size()!=std::min<size_t>(k,map.size())){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        for(unsigned index=0;index<nearest.size();index=index+1){
+            long long distance=nearest[index].first>probe?nearest[index].first-probe:probe-nearest[index].first;
+            if(distance!=distances[index]||map.at(nearest[index].first)!=nearest[index].second){
+                char errorMassage[1024];
+                sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+                throw std::logic_error(errorMassage);
+            }
+        }
+    }
+    RBTreeArray16<double,unsigned> treeEmpty;
+    auto neighbors=treeEmpty.Neighbors(1.0);
+    if(neighbors.first!=treeEmpty.OrderedEnd()||neighbors.second!=treeEmpty.OrderedEnd()||!treeEmpty.Nearest(1.0,3,[](double a,double b){return a>b?a-b:b-a;}).empty()){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    // distances of extreme neighbors do not fit the key type, -1 to INT_MAX is bigger than -1 to INT_MIN
+    RBTreeArray16<int,unsigned> treeExtreme={{INT_MIN,1},{0,2},{INT_MAX,3}};
+    std::vector<std::pair<int,unsigned>> nearestExtreme=treeExtreme.Nearest(-1,3);
+    if(nearestExtreme.size()!=3||nearestExtreme[0].first!=0||nearestExtreme[1].first!=INT_MIN||nearestExtreme[2].first!=INT_MAX){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    RBTreeArray16<long long,unsigned> treeExtreme64={{LLONG_MIN,1},{LLONG_MAX,2}};
+    std::vector<std::pair<long long,unsigned>> nearestExtreme64=treeExtreme64.Nearest(1,2);
+    if(nearestExtreme64.size()!=2||nearestExtreme64[0].first!=LLONG_MAX||nearestExtreme64[1].first!=LLONG_MIN){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    RBTreeArray16<uint8_t,unsigned> treeNarrow={{0,1},{250,2}};
+    std::vector<std::pair<uint8_t,unsigned>> nearestNarrow=treeNarrow.Nearest(200,2);
+    if(nearestNarrow.size()!=2||nearestNarrow[0].first!=250||nearestNarrow[1].first!=0){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("NearestTest passed\n========================\n");
+}
+
+// every kernel the CPU can run must agree with the scalar loop, the values mix sign boundaries, NaN and a partial tail
+template<typename Predicate,typename Type>
+bool MatchKernelAgree(const Predicate& predicate,const Type* values,uint64_t count){
+    uint64_t expected=RBTreeArrayMatchScalar(predicate,values,count);
+#if RBTREE_ARRAY_SIMD_DISPATCH
+    RBTreeArraySIMDLevel level=RBTreeArrayDetectSIMDLevel();
+    if((level>=RBTreeArraySIMDLevel::SSE42&&RBTreeArrayMatchSSE42(predicate,values,count)!=expected)
+        ||(level>=RBTreeArraySIMDLevel::AVX2&&RBTreeArrayMatchAVX2(predicate,values,count)!=expected)
+        ||(level>=RBTreeArraySIMDLevel::AVX512&&RBTreeArrayMatchAVX512(predicate,values,count)!=expected)){
+        return false;
+    }
+#endif
+    return true;
+}
+
+template<typename Type>
+bool MatchKernelBitMaskAgree(Type mask,Type expected,const Type* values,uint64_t count,std::true_type){
+    return MatchKernelAgree(RBTreeArrayBitMask<Type>(mask,expected&mask),values,count);
+}
+
+template<typename Type>
+bool MatchKernelBitMaskAgree(Type mask,Type expected,const Type* values,uint64_t count,std::false_type){
+    return true;
+}
+
+template<typename Type>
+void MatchKernelCheck(PCG32Struct* PCGStatus){
+    const Type specials[]={std::numeric_limits<Type>::lowest(),std::numeric_limits<Type>::max(),std::numeric_limits<Type>::min(),
+        static_cast<Type>(0),static_cast<Type>(-1),static_cast<Type>(1),std::numeric_limits<Type>::quiet_NaN()};
+    auto random=[&](){
+        if(PCG32(PCGStatus)%4==0){
+            return specials[PCG32(PCGStatus)%(sizeof(specials)/sizeof(Type))];
+        }
+        return static_cast<Type>(static_cast<int32_t>(PCG32(PCGStatus)%64)-32);
+    };
+    Type values[64];
+    for(unsigned round=0;round<2000;round=round+1){
+        for(unsigned index=0;index<64;index=index+1){
+            values[index]=random();
+        }
+        uint64_t count=round%2?64:PCG32(PCGStatus)%65;
+        if(!MatchKernelAgree(RBTreeArrayRange<Type>(random(),random()),values,count)
+            ||!MatchKernelAgree(RBTreeArrayEqualSet<Type>({random(),random(),random()}),values,count)
+            ||!MatchKernelBitMaskAgree(random(),random(),values,count,std::is_integral<Type>())){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+}
+
+void ScanWhereTest(){
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+
+    RBTreeArray32<unsigned,double> tree;
+    std::map<unsigned,double> map;
+    for(unsigned index=0;index<20000;index=index+1){
+        unsigned key=PCG32Uniform(&PCGStatus,0,100000);
+        double value=PCG32Uniform(&PCGStatus,0,1000)/1000.0;
+        tree.Insert(key,value);
+        map[key]=value;
+    }
+    for(unsigned round=0;round<50;round=round+1){
+        unsigned low=PCG32Uniform(&PCGStatus,0,100000);
+        unsigned high=low+PCG32Uniform(&PCGStatus,0,20000);
+        double valueLow=PCG32Uniform(&PCGStatus,0,1000)/1000.0;
+        unsigned mask=PCG32Uniform(&PCGStatus,0,16);
+        unsigned expected=PCG32Uniform(&PCGStatus,0,16)&mask;
+        RBTreeArrayEqualSet<unsigned> equalSet({PCG32Uniform(&PCGStatus,0,100000),PCG32Uniform(&PCGStatus,0,100000),map.begin()->first,map.rbegin()->first});
+        uint64_t rangeCount=0,valueCount=0,maskCount=0,setCount=0;
+        std::vector<unsigned> rangeKeys;
+        for(const auto& pair:map){
+            if(pair.first>=low&&pair.first<=high){
+                rangeCount=rangeCount+1;
+                rangeKeys.push_back(pair.first);
+            }
+            valueCount=valueCount+(pair.second>=valueLow&&pair.second<=1.0);
+            maskCount=maskCount+((pair.first&mask)==expected);
+            setCount=setCount+equalSet(pair.first,pair.second);
+        }
+        std::vector<unsigned> keys=tree.FilterKeys(RBTreeArrayRange<unsigned>(low,high));
+        std::sort(keys.begin(),keys.end());
+        uint64_t scanCount=tree.ScanWhere(RBTreeArrayRange<double,RBTreeArrayField::Value>(valueLow,1.0),[&](unsigned key,double value){
+            if(value<valueLow||map.at(key)!=value){
+                char errorMassage[1024];
+                sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+                throw std::logic_error(errorMassage);
+            }
+        });
+        if(tree.CountWhere(RBTreeArrayRange<unsigned>(low,high))!=rangeCount||keys!=rangeKeys||scanCount!=valueCount
+            ||tree.CountWhere(RBTreeArrayBitMask<unsigned>(mask,expected))!=maskCount||tree.CountWhere(equalSet)!=setCount
+            ||tree.CountWhere([&](unsigned key,double value){return key>=low&&key<=high;})!=rangeCount){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    uint64_t deleted=tree.ConditionalDelete(RBTreeArrayBitMask<unsigned>(1,1));
+    uint64_t oddCount=0;
+    for(auto iterator=map.begin();iterator!=map.end();){
+        if(iterator->first&1){
+            oddCount=oddCount+1;
+            iterator=map.erase(iterator);
+        }else{
+            ++iterator;
+        }
+    }
+    if(deleted!=oddCount||tree.KeyCount()!=map.size()||tree.CountWhere(RBTreeArrayBitMask<unsigned>(1,1))!=0){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    for(const auto& pair:map){
+        double value;
+        if(!tree.Search(pair.first,value)||value!=pair.second){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    MatchKernelCheck<int32_t>(&PCGStatus);
+    MatchKernelCheck<uint32_t>(&PCGStatus);
+    MatchKernelCheck<int64_t>(&PCGStatus);
+    MatchKernelCheck<uint64_t>(&PCGStatus);
+    MatchKernelCheck<float>(&PCGStatus);
+    MatchKernelCheck<double>(&PCGStatus);
+    MatchKernelCheck<int16_t>(&PCGStatus);
+    printf("ScanWhereTest passed\n========================\n");
+}
+
+void ViewTest(){
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+
+    RBTreeArray32<unsigned,std::string> tree;
+    std::map<unsigned,std::string> map;
+    for(unsigned index=0;index<5000;index=index+1){
+        unsigned key=PCG32Uniform(&PCGStatus,0,100000);
+        tree.Insert(key,std::to_string(index));
+        map[key]=std::to_string(index);
+    }
+    std::vector<unsigned> keys=tree.Keys();
+    std::vector<std::string> values=tree.Values();
+    std::vector<unsigned> keysView;
+    std::vector<std::string> valuesView;
+    for(unsigned key:tree.KeysView()){
+        keysView.push_back(key);
+    }
+    for(const std::string& value:tree.ValuesView()){
+        valuesView.push_back(value);
+    }
+    if(keysView!=keys||valuesView!=values||tree.KeysView().size()!=tree.KeyCount()){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    auto mapIterator=map.begin();
+    for(auto pair:tree.OrderedKeysValuesView()){
+        if(mapIterator==map.end()||pair.first!=mapIterator->first||pair.second!=mapIterator->second){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        ++mapIterator;
+    }
+    for(std::string& value:tree.OrderedValuesView()){
+        value=value+"v";
+    }
+
+    unsigned* orderedKeys=(unsigned*)malloc(sizeof(unsigned)*tree.KeyCount());
+    unsigned* end=tree.KeysTo(orderedKeys,true);
+    std::vector<std::pair<unsigned,std::string>> pairs;
+    tree.KeysValuesTo(std::back_inserter(pairs));
+    std::vector<std::string> valuesTo;
+    tree.ValuesTo(std::back_inserter(valuesTo),true);
+    std::vector<const unsigned*> keysPointer=tree.KeysPointer();
+    std::vector<std::string*> valuesPointer=tree.ValuesPointer();
+    if((uint64_t)(end-orderedKeys)!=map.size()||pairs.size()!=map.size()||valuesTo.size()!=map.size()||keysPointer.size()!=map.size()||valuesPointer.size()!=map.size()){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    uint64_t position=0;
+    for(const auto& pair:map){
+        if(orderedKeys[position]!=pair.first||valuesTo[position]!=pair.second+"v"
+            ||map.at(pairs[position].first)+"v"!=pairs[position].second||*(keysPointer[position])!=keys[position]||*(valuesPointer[position])!=values[position]+"v"){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        position=position+1;
+    }
+    free(orderedKeys);
+    uint64_t count=0;
+    tree.ForEachKeyValue([&](unsigned key,std::string& value){count=count+(map.at(key)+"v"==value);});
+    RBTreeArray16<unsigned,unsigned> treeEmpty;
+    if(count!=map.size()||!treeEmpty.OrderedKeysView().empty()||treeEmpty.KeysView().begin()!=treeEmpty.KeysView().end()
+        ||treeEmpty.OrderedValuesView().begin()!=treeEmpty.OrderedValuesView().end()){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("ViewTest passed\n========================\n");
+}
+
+void ExportImportSortedTest(){
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+
+    RBTreeArray64<long long,double> tree64;
+    std::map<long long,double> map;
+    for(unsigned index=0;index<80000;index=index+1){
+        long long key=(long long)PCG32Uniform(&PCGStatus,0,2000000)-1000000;
+        tree64.Insert(key,index*0.5);
+        map[key]=index*0.5;
+    }
+    for(int deltaKeys=0;deltaKeys<2;deltaKeys=deltaKeys+1){
+        std::vector<char> stream;
+        bool exported=tree64.ExportSorted([&](const void* data,uint64_t byteSize){
+            stream.insert(stream.end(),(const char*)data,(const char*)data+byteSize);
+            return true;
+        },1000,deltaKeys);
+        uint64_t position=0;
+        auto reader=[&](void* data,uint64_t byteSize){
+            if(stream.size()-position<byteSize){
+                return false;
+            }
+            memcpy(data,stream.data()+position,byteSize);
+            position=position+byteSize;
+            return true;
+        };
+        RBTreeArray32<long long,double> tree32;
+        tree32.Insert(1LL<<40,1.0);
+        if(!exported||!tree32.ImportSorted(reader)||tree32.KeyCount()!=map.size()){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        for(unsigned round=0;round<20000;round=round+1){
+            long long key=(long long)PCG32Uniform(&PCGStatus,0,2000000)-1000000;
+            if(PCG32(&PCGStatus)&1){
+                tree32.Insert(key,round);
+                map[key]=round;
+            }else{
+                tree32.Delete(key);
+                map.erase(key);
+            }
+        }
+        if(!NodeCompare(tree32,map)){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        // a truncated stream leaves the tree unchanged
+        stream.resize(stream.size()/2);
+        position=0;
+        if(tree32.ImportSorted(reader)||!NodeCompare(tree32,map)){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        tree64.Clear();
+        for(const auto& pair:map){
+            tree64.Insert(pair.first,pair.second);
+        }
+    }
+    // too large for the 16 bit tree
+    RBTreeArray16<long long,double> tree16;
+    std::vector<char> stream;
+    tree64.ExportSorted([&](const void* data,uint64_t byteSize){
+        stream.insert(stream.end(),(const char*)data,(const char*)data+byteSize);
+        return true;
+    });
+    uint64_t position=0;
+    if(map.size()<=tree16.MaxNodeCount||tree16.ImportSorted([&](void* data,uint64_t byteSize){
+        if(stream.size()-position<byteSize){
+            return false;
+        }
+        memcpy(data,stream.data()+position,byteSize);
+        position=position+byteSize;
+        return true;
+    })){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    // a crafted count whose block size wraps is rejected before anything is allocated or written
+    RBTreeArraySortedStreamHeader header;
+    header.magic=RBTreeArraySortedStreamHeader::Magic;
+    header.version=RBTreeArraySortedStreamHeader::Version;
+    header.flags=0;
+    header.keySize=sizeof(long long);
+    header.valueSize=sizeof(double);
+    header.count=1ULL<<60;
+    bool headerRead=false;
+    if(tree64.ImportSorted([&](void* data,uint64_t byteSize){
+        if(headerRead||byteSize!=sizeof(header)){
+            return false;
+        }
+        memcpy(data,&header,sizeof(header));
+        headerRead=true;
+        return true;
+    })||!NodeCompare(tree64,map)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("ExportImportSortedTest passed\n========================\n");
+}
+
+void CompactSnapshotTest(){
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+
+    RBTreeArray64<uint64_t,uint32_t> tree64;
+    std::map<uint64_t,uint32_t> map;
+    for(unsigned index=0;index<50000;index=index+1){
+        uint64_t key=((uint64_t)PCG32(&PCGStatus)<<20)+PCG32Uniform(&PCGStatus,0,1000);
+        uint32_t value=PCG32(&PCGStatus)%(index+1);
+        tree64.Insert(key,value);
+        map[key]=value;
+    }
+    std::vector<char> snapshot(tree64.CompactByteSize());
+    if(!tree64.WriteCompact(snapshot.data())||snapshot.size()>=tree64.ByteSize()){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    RBTreeArray32<uint64_t,uint32_t> tree32;
+    tree32.Insert(1,1);
+    if(!tree32.ReadCompact(snapshot.data(),snapshot.size())||!NodeCompare(tree32,map)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    for(const auto& pair:map){
+        uint32_t value;
+        if(!tree32.Search(pair.first,value)||value!=pair.second){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    for(unsigned round=0;round<20000;round=round+1){
+        uint64_t key=((uint64_t)PCG32(&PCGStatus)<<20)+PCG32Uniform(&PCGStatus,0,1000);
+        tree32.Insert(key,round);
+        map[key]=round;
+        auto iterator=map.begin();
+        tree32.Delete(iterator->first);
+        map.erase(iterator);
+    }
+    if(!NodeCompare(tree32,map)||tree32.ReadCompact(snapshot.data(),snapshot.size()-1)||!NodeCompare(tree32,map)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    // signed key, raw value
+    RBTreeArray16<int,double> tree16;
+    std::map<int,double> map16;
+    for(int index=-2000;index<2000;index=index+1){
+        int key=index*(int)PCG32Uniform(&PCGStatus,1,100);
+        tree16.Insert(key,index*0.25);
+        map16[key]=index*0.25;
+    }
+    std::vector<char> snapshot16(tree16.CompactByteSize());
+    tree16.WriteCompact(snapshot16.data());
+    RBTreeArray64<int,double> treeSigned;
+    if(!treeSigned.ReadCompact(snapshot16.data(),snapshot16.size())||!NodeCompare(treeSigned,map16)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    for(const auto& pair:map16){
+        double value;
+        if(!treeSigned.Search(pair.first,value)||value!=pair.second){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    RBTreeArray32<uint64_t,uint32_t> treeEmpty;
+    std::vector<char> snapshotEmpty(treeEmpty.CompactByteSize());
+    treeEmpty.WriteCompact(snapshotEmpty.data());
+    if(!tree32.ReadCompact(snapshotEmpty.data(),snapshotEmpty.size())||tree32.KeyCount()||!tree32.Insert(5,5)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    // crafted counts: one whose block size wraps, one far beyond what the snapshot bytes can hold
+    RBTreeArrayCompactHeader header;
+    memcpy(&header,snapshot.data(),sizeof(header));
+    RBTreeArray64<uint64_t,uint32_t> treeCrafted;
+    treeCrafted.Insert(7,7);
+    for(uint64_t count:{1ULL<<60,1ULL<<30}){
+        header.count=count;
+        memcpy(snapshot.data(),&header,sizeof(header));
+        if(treeCrafted.ReadCompact(snapshot.data(),snapshot.size())||treeCrafted.KeyCount()!=1){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    printf("CompactSnapshotTest passed\n========================\n");
+}
+
+void PagedTest(){
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+    const char* path="RBTreeArrayPagedTest.bin";
+    unlink(path);
+
+    std::map<uint64_t,uint32_t> map;
+    const long long blocksBefore=testHeapBlocks;
+    {
+        RBTreeArrayPaged32<uint64_t,uint32_t> paged(path,16*4096,4096); // 16 pages, most operations evict
+        // the pool object and its frames come from the allocation hooks
+        if(testHeapBlocks!=blocksBefore+2){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        for(unsigned round=0;round<100000;round=round+1){
+            uint64_t key=PCG32Uniform(&PCGStatus,0,30000);
+            if(PCG32Uniform(&PCGStatus,0,3)){
+                paged.Insert(key,round);
+                map[key]=round;
+            }else if(paged.Delete(key)!=static_cast<bool>(map.erase(key))){
+                char errorMassage[1024];
+                sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+                throw std::logic_error(errorMassage);
+            }
+        }
+        if(paged.KeyCount()!=map.size()||!paged.PoolStatistics().evictions){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    if(testHeapBlocks!=blocksBefore){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    RBTreeArrayPaged32<uint64_t,uint32_t> reopened(path);
+    for(const auto& pair:map){
+        uint32_t value;
+        if(!reopened.Search(pair.first,value)||value!=pair.second){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    // the file is a RBTree block
+    FILE* file=fopen(path,"rb");
+    std::vector<char> block(reopened.ByteSize());
+    if(!file||fread(block.data(),1,block.size(),file)!=block.size()){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    fclose(file);
+    RBTreeArray32<uint64_t,uint32_t> tree;
+    if(!tree.ReadWithIndexes(block.data(),block.size())||!NodeCompare(tree,map)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    bool thrown=false;
+    try{
+        RBTreeArrayPaged64<uint64_t,uint32_t> wrongBitLength(path);
+    }catch(const std::invalid_argument&){
+        thrown=true;
+    }
+    unlink(path);
+    if(!thrown){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("PagedTest passed\n========================\n");
+}
+
+void MappedTest(){
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+    const char* path="RBTreeArrayMappedTest.bin";
+
+    RBTreeArray32<uint64_t,uint32_t> tree;
+    std::map<uint64_t,uint32_t> map;
+    for(unsigned index=0;index<200000;index=index+1){
+        uint64_t key=((uint64_t)PCG32(&PCGStatus)<<32)|PCG32(&PCGStatus);
+        tree.Insert(key,index);
+        map[key]=index;
+    }
+    FILE* file=fopen(path,"wb");
+    if(!file||fwrite(tree.Data(),1,tree.ByteSize(),file)!=tree.ByteSize()){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    fclose(file);
+    for(int populate=0;populate<2;populate=populate+1){
+        RBTreeArrayMapped32<uint64_t,uint32_t> mapped(path,populate);
+        mapped.SetFaultAccounting(true);
+        for(const auto& pair:map){
+            uint32_t value;
+            if(!mapped.Search(pair.first,value)||value!=pair.second){
+                char errorMassage[1024];
+                sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+                throw std::logic_error(errorMassage);
+            }
+        }
+        if(!NodeCompare(mapped.Tree(),map)||mapped.GetStatistics().lookups!=map.size()||mapped.ResidentPages()>mapped.MappedPages()
+            ||(!populate&&!mapped.GetStatistics().prefetchedPages)){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    // a child index past the nodes and a cycle back to the root must not be followed by Prefetch
+    {
+        RBTreeArray32<uint64_t,uint32_t> corrupt(tree);
+        RBTree* block=corrupt.Data();
+        const uint64_t nodeSize=(corrupt.ByteSize()-sizeof(RBTree))/block->size;
+        uint32_t* root=(uint32_t*)(block->nodes+nodeSize*block->rootIndex);
+        const uint64_t rootIndex=block->rootIndex;
+        root[1]=0x7FFFFFF0;
+        root[2]=(uint32_t)block->rootIndex;
+        file=fopen(path,"wb");
+        if(!file||fwrite(block,1,corrupt.ByteSize(),file)!=corrupt.ByteSize()){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        fclose(file);
+        RBTreeArrayMapped32<uint64_t,uint32_t> mapped(path,false,64);
+        if(mapped.Prefetch(64)>mapped.MappedPages()*64){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        block->rootIndex=block->size;
+        file=fopen(path,"wb");
+        if(!file||fwrite(block,1,corrupt.ByteSize(),file)!=corrupt.ByteSize()){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        fclose(file);
+        RBTreeArrayMapped32<uint64_t,uint32_t> badRoot(path,false,64);
+        if(badRoot.Prefetch(64)!=0){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        block->rootIndex=rootIndex;
+    }
+    bool thrown=false;
+    try{
+        RBTreeArrayMapped16<uint64_t,uint32_t> wrongBitLength(path);
+    }catch(const std::invalid_argument&){
+        thrown=true;
+    }
+    unlink(path);
+    if(!thrown){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("MappedTest passed\n========================\n");
+}
+
+void DirtyFlushTest(){
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+    const char* path="RBTreeArrayDirtyFlushTest.bin";
+    const uint64_t pageSize=sysconf(_SC_PAGESIZE);
+
+    RBTreeArray32<uint64_t,uint32_t> tree(1<<18);
+    std::map<uint64_t,uint32_t> map;
+    for(unsigned index=0;index<100000;index=index+1){
+        uint64_t key=((uint64_t)PCG32(&PCGStatus)<<32)|PCG32(&PCGStatus);
+        tree.Insert(key,index);
+        map[key]=index;
+    }
+    FILE* file=fopen(path,"wb");
+    if(!file||fwrite(tree.Data(),1,tree.ByteSize(),file)!=tree.ByteSize()){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    fclose(file);
+    uint64_t byteSize=tree.ByteSize();
+    int fd=open(path,O_RDWR);
+    void* mapping=mmap(NULL,byteSize,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+    RBTreeArray32<uint64_t,uint32_t> mappedTree(1);
+    RBTree* ownTree=mappedTree.Data();
+    if(mapping==MAP_FAILED||!mappedTree.SetTreeWithoutDestoryMyTree((RBTree*)mapping)||!mappedTree.EnableDirtyTracking(pageSize)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    uint8_t* snapshot=(uint8_t*)malloc(byteSize);
+    for(unsigned round=0;round<20;round=round+1){
+        memcpy(snapshot,mapping,byteSize);
+        for(unsigned index=0;index<500;index=index+1){
+            uint64_t key=((uint64_t)PCG32(&PCGStatus)<<32)|PCG32(&PCGStatus);
+            mappedTree.Insert(key,index);
+            map[key]=index;
+            auto iterator=map.lower_bound(((uint64_t)PCG32(&PCGStatus)<<32)|PCG32(&PCGStatus));
+            if(iterator==map.end()){
+                continue;
+            }
+            if(index&1){
+                mappedTree.Delete(iterator->first);
+                map.erase(iterator);
+            }else{
+                mappedTree[iterator->first]=round;
+                iterator->second=round;
+            }
+        }
+        std::set<uint64_t> dirty(mappedTree.DirtyPages().begin(),mappedTree.DirtyPages().end());
+        for(uint64_t page=0;page*pageSize<byteSize;page=page+1){
+            uint64_t length=std::min(pageSize,byteSize-page*pageSize);
+            if(memcmp(snapshot+page*pageSize,(uint8_t*)mapping+page*pageSize,length)&&!dirty.count(page)){
+                char errorMassage[1024];
+                sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+                throw std::logic_error(errorMassage);
+            }
+        }
+        if(dirty.size()!=mappedTree.DirtyPageCount()||!mappedTree.FlushDirty()||mappedTree.DirtyPageCount()!=0){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    free(snapshot);
+    mappedTree.SetTreeWithoutDestoryMyTree(ownTree);
+    munmap(mapping,byteSize);
+    close(fd);
+
+    RBTreeArray32<uint64_t,uint32_t> reloaded(1);
+    file=fopen(path,"rb");
+    RBTree* buffer=(RBTree*)malloc(byteSize);
+    if(!file||fread(buffer,1,byteSize,file)!=byteSize||!reloaded.SetTree(buffer)||!NodeCompare(reloaded,map)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    fclose(file);
+    unlink(path);
+
+    // swaps of the node array by the tree itself keep tracking on with the whole new block dirty, SetTree switches it off
+    RBTreeArray32<uint64_t,uint32_t> tracked;
+    std::map<uint64_t,uint32_t> trackedMap;
+    for(unsigned index=0;index<20000;index=index+1){
+        uint64_t key=((uint64_t)PCG32(&PCGStatus)<<32)|PCG32(&PCGStatus);
+        tracked.Insert(key,index);
+        trackedMap[key]=index;
+    }
+    tracked.EnableDirtyTracking(pageSize);
+    tracked.ConditionalDelete([](uint64_t key,uint32_t value){return key%10!=0;});
+    for(auto iterator=trackedMap.begin();iterator!=trackedMap.end();){
+        if(iterator->first%10!=0){
+            iterator=trackedMap.erase(iterator);
+        }else{
+            ++iterator;
+        }
+    }
+    if(tracked.DirtyPageCount()!=(tracked.ByteSize()+pageSize-1)/pageSize||!NodeCompare(tracked,trackedMap)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    uint64_t arraySize=tracked.ArraySize();
+    for(uint32_t index=0;tracked.ArraySize()==arraySize;index=index+1){
+        uint64_t key=((uint64_t)PCG32(&PCGStatus)<<32)|PCG32(&PCGStatus);
+        tracked.Insert(key,index);
+        trackedMap[key]=index;
+    }
+    if(tracked.DirtyPageCount()!=(tracked.ByteSize()+pageSize-1)/pageSize||!NodeCompare(tracked,trackedMap)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    RBTree* trackedCopy=(RBTree*)malloc(tracked.ByteSize());
+    memcpy(trackedCopy,tracked.Data(),tracked.ByteSize());
+    tracked.SetTree(trackedCopy);
+    tracked.Insert(1,1);
+    if(tracked.DirtyPageCount()!=0){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("DirtyFlushTest passed\n========================\n");
+}
+
+template<typename TreeType,typename MapType,typename KeyFunction>
+void IncrementalGrowthRun(TreeType& tree,MapType& map,KeyFunction&& keyFunction,unsigned operationCount){
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+    unsigned growths=0;
+    for(unsigned index=0;index<operationCount;index=index+1){
+        bool growing=tree.Growing();
+        uint64_t arraySize=tree.ArraySize();
+        auto key=keyFunction(PCG32(&PCGStatus)%(operationCount*2));
+        auto value=keyFunction(index);
+        switch(PCG32(&PCGStatus)%4){
+        case 0:
+        case 1:
+            tree.Insert(key,value);
+            map[key]=value;
+            break;
+        case 2:
+            tree[key]=value;
+            map[key]=value;
+            break;
+        default:
+            tree.Delete(key);
+            map.erase(key);
+        }
+        if(tree.ArraySize()!=arraySize){
+            // the array may only be replaced by a migration that was already running
+            if(!growing){
+                char errorMassage[1024];
+                sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+                throw std::logic_error(errorMassage);
+            }
+            growths=growths+1;
+            if(!NodeCompare(tree,map)){
+                char errorMassage[1024];
+                sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+                throw std::logic_error(errorMassage);
+            }
+        }
+    }
+    for(const auto& pair:map){
+        typename MapType::mapped_type value;
+        if(!tree.Search(pair.first,value)||value!=pair.second){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    if(growths<3||!NodeCompare(tree,map)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+}
+
+// copies, default constructions and destructions are counted, the work a migration does inside one operation
+static uint64_t countedValueWork=0;
+struct CountedValue{
+    uint64_t value=0;
+    CountedValue(){countedValueWork=countedValueWork+1;}
+    explicit CountedValue(uint64_t value):value(value){}
+    CountedValue(const CountedValue& another):value(another.value){countedValueWork=countedValueWork+1;}
+    CountedValue& operator=(const CountedValue& another){value=another.value;countedValueWork=countedValueWork+1;return *this;}
+    ~CountedValue(){countedValueWork=countedValueWork+1;}
+};
+
+void IncrementalGrowthTest(){
+    RBTreeArray32<uint64_t,uint64_t> tree(256);
+    std::map<uint64_t,uint64_t> map;
+    tree.SetIncrementalGrowth(16);
+    IncrementalGrowthRun(tree,map,[](uint64_t number){return number;},400000);
+
+    RBTreeArray32<std::string,std::string> stringTree(256);
+    std::map<std::string,std::string> stringMap;
+    stringTree.SetIncrementalGrowth(64);
+    IncrementalGrowthRun(stringTree,stringMap,[](uint64_t number){return std::to_string(number);},100000);
+
+    // values written through several live references and an iterator during a migration survive the swap
+    RBTreeArray32<uint64_t,uint64_t> referenceTree(256);
+    referenceTree.SetIncrementalGrowth(4);
+    uint64_t key=0;
+    while(!referenceTree.Growing()){
+        referenceTree.Insert(key,key);
+        key=key+1;
+    }
+    uint64_t& first=referenceTree[0];
+    uint64_t& second=referenceTree[1];
+    referenceTree.Insert(key,key);
+    key=key+1;
+    first=1000;
+    second=1001;
+    for(auto iterator=referenceTree.begin();iterator!=referenceTree.end();++iterator){
+        if((*iterator).first==2){
+            (*iterator).second=1002;
+        }
+    }
+    uint64_t arraySize=referenceTree.ArraySize();
+    while(referenceTree.ArraySize()==arraySize){
+        referenceTree.Insert(key,key);
+        key=key+1;
+    }
+    uint64_t values[]={1000,1001,1002,3};
+    for(uint64_t index=0;index<4;index=index+1){
+        uint64_t value=0;
+        if(referenceTree.Growing()||!referenceTree.Search(index,value)||value!=values[index]){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+
+    // with an iterator open and written through during each migration, no operation copies or destroys more than its
+    // share of nodes: nothing is copied back at the swap and the old block is destroyed over the following operations
+    const uint64_t growStep=8;
+    RBTreeArray32<uint64_t,CountedValue> countedTree(256);
+    std::map<uint64_t,uint64_t> countedMap;
+    countedTree.SetIncrementalGrowth(growStep);
+    uint64_t next=0;
+    uint64_t mostWork=0;
+    for(unsigned growths=0;growths<3;growths=growths+1){
+        while(!countedTree.Growing()){
+            uint64_t work=countedValueWork;
+            countedTree.Insert(next,CountedValue(next));
+            mostWork=std::max(mostWork,countedValueWork-work);
+            countedMap[next]=next;
+            next=next+1;
+        }
+        RBTreeArray32<uint64_t,CountedValue>::UnorderedIterator iterator=countedTree.begin();
+        CountedValue& kept=countedTree[0];
+        uint64_t arraySize=countedTree.ArraySize();
+        while(countedTree.Growing()){
+            if(iterator!=countedTree.end()){
+                (*iterator).second.value=(*iterator).first*3;
+                countedMap[(*iterator).first]=(*iterator).first*3;
+                ++iterator;
+            }
+            uint64_t work=countedValueWork;
+            countedTree.Insert(next,CountedValue(next));
+            mostWork=std::max(mostWork,countedValueWork-work);
+            countedMap[next]=next;
+            if(next%5==0){
+                work=countedValueWork;
+                countedTree.Delete(next/2);
+                mostWork=std::max(mostWork,countedValueWork-work);
+                countedMap.erase(next/2);
+            }
+            next=next+1;
+        }
+        kept.value=growths+7;
+        countedMap[0]=growths+7;
+        if(countedTree.ArraySize()!=arraySize*2){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    if(mostWork>growStep+8||countedTree.KeyCount()!=countedMap.size()){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    for(const auto& pair:countedMap){
+        CountedValue value;
+        if(!countedTree.Search(pair.first,value)||value.value!=pair.second){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    printf("IncrementalGrowthTest passed\n========================\n");
+}
+
+void StatisticsTest(){
+    RBTreeArray32<uint32_t,uint32_t> tree;
+    RBTreeArrayShape shape=tree.Shape();
+    if(shape.keyCount||shape.height||shape.blackHeight||shape.arraySize!=tree.ArraySize()||shape.fragmentation!=1.0){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    RBTreeArrayStatistics before=RBTreeArrayThreadStatistics();
+    const uint32_t count=100000;
+    for(uint32_t key=0;key<count;key=key+1){
+        tree.Insert(key,key);
+    }
+    for(uint32_t key=0;key<count;key=key+2){
+        tree.Delete(key);
+    }
+    uint32_t value;
+    for(uint32_t key=0;key<count;key=key+1){
+        tree.Search(key,value);
+    }
+    tree.ConditionalDelete([](uint32_t key,uint32_t value){return key%3==0;});
+    shape=tree.Shape();
+    // a red-black tree is at most twice as high as a perfectly balanced one, and every path has blackHeight black nodes
+    double perfect=log2(double(shape.keyCount)+1);
+    if(shape.keyCount!=tree.KeyCount()||shape.height<perfect||shape.height>2*perfect+1||shape.blackHeight<(shape.height+1)/2
+        ||shape.averageDepth<=0||shape.averageDepth>=shape.height
+        ||shape.fragmentation!=double(tree.ArraySize()-tree.KeyCount())/double(tree.ArraySize())){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    RBTreeArrayStatistics after=RBTreeArrayThreadStatistics();
+#if RBTREE_ARRAY_STATISTICS
+    bool counted=after.searches-before.searches==count&&after.comparisons-before.comparisons>=count*(shape.height/2)
+        &&after.rotations>before.rotations&&after.recolorings>before.recolorings&&after.relocations>before.relocations
+        &&after.resizes>before.resizes&&after.bytesCopied>before.bytesCopied
+        &&after.conditionalDeleteByKeys+after.conditionalDeleteInOrder+after.conditionalDeleteRebuild
+        ==before.conditionalDeleteByKeys+before.conditionalDeleteInOrder+before.conditionalDeleteRebuild+1;
+#else
+    bool counted=!memcmp(&before,&after,sizeof(RBTreeArrayStatistics));
+#endif
+    if(!counted){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("StatisticsTest passed\n========================\n");
+}
+
+struct MemoryUsageBuffer{
+    uint64_t size=0;
+    char* data=nullptr;
+    bool operator<(const MemoryUsageBuffer& another)const{return size<another.size;}
+    bool operator>(const MemoryUsageBuffer& another)const{return size>another.size;}
+};
+
+template<>
+struct RBTreeArrayHeapSize<MemoryUsageBuffer>{
+    static uint64_t Get(const MemoryUsageBuffer& buffer)noexcept{return buffer.size;}
+};
+
+void MemoryUsageTest(){
+    RBTreeArray32<uint64_t,std::vector<uint64_t>> vectorTree;
+    uint64_t expected=0;
+    for(uint64_t key=0;key<1000;key=key+1){
+        std::vector<uint64_t> value(key%17);
+        expected=expected+value.size()*sizeof(uint64_t);
+        vectorTree.Insert(key,value);
+    }
+    RBTreeArrayMemoryUsage usage=vectorTree.MemoryUsage();
+    if(usage.blockBytes!=vectorTree.ByteSize()||usage.headerBytes+usage.liveBytes+usage.unusedBytes!=usage.blockBytes
+        ||usage.nestedBytes<expected||usage.totalBytes!=usage.blockBytes+usage.nestedBytes){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    RBTreeArray32<std::string,std::vector<std::string>> stringTree;
+    std::string longText(100,'x');
+    stringTree.Insert("a",{});
+    stringTree.Insert(longText,{longText,"b"});
+    usage=stringTree.MemoryUsage();
+    // only the two long strings and the vector buffer own heap
+    if(usage.nestedBytes<2*(longText.size()+1)+2*sizeof(std::string)||usage.nestedBytes>4*(longText.size()+1)+2*sizeof(std::string)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+
+    RBTreeArray32<uint32_t,std::map<uint32_t,MemoryUsageBuffer>> mapTree;
+    mapTree[1][2].size=1000;
+    mapTree[1][3].size=24;
+    mapTree[2];
+    usage=mapTree.MemoryUsage();
+    RBTreeArray32<uint32_t,uint8_t> paddedTree;
+    paddedTree.Insert(1,1);
+    if(usage.nestedBytes<1024+2*sizeof(std::pair<const uint32_t,MemoryUsageBuffer>)||paddedTree.MemoryUsage().paddingBytes==0){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("MemoryUsageTest passed\n========================\n");
+}
+
+void TraceTest(){
+    std::vector<RBTreeArrayTraceRecord> records;
+    RBTreeArraySetTraceCallback([](const RBTreeArrayTraceRecord& record,void* context){
+        static_cast<std::vector<RBTreeArrayTraceRecord>*>(context)->push_back(record);
+    },&records);
+    RBTreeArray32<uint32_t,uint32_t> tree;
+    for(uint32_t key=0;key<10000;key=key+1){
+        tree.Insert(key,key);
+    }
+    tree.ReSize(40000);
+    tree.MemoryShrink();
+    RBTreeArray64<uint32_t,uint32_t> another;
+    another.Transform(tree);
+    tree.ConditionalDelete([](uint32_t key,uint32_t value){return key%10==0;});
+    tree.ConditionalDelete([](uint32_t key,uint32_t value){return key%3==0;});
+    tree.ConditionalDelete([](uint32_t key,uint32_t value){return key>=1000;});
+    std::vector<char> buffer;
+    tree.ExportSorted([&buffer](const void* data,uint64_t byteSize)->bool{
+        buffer.insert(buffer.end(),(const char*)data,(const char*)data+byteSize);
+        return true;
+    });
+    uint64_t position=0;
+    another.ImportSorted([&buffer,&position](void* data,uint64_t byteSize)->bool{
+        if(position+byteSize>buffer.size()){
+            return false;
+        }
+        memcpy(data,buffer.data()+position,byteSize);
+        position=position+byteSize;
+        return true;
+    });
+    RBTreeArraySetTraceCallback(nullptr);
+#if RBTREE_ARRAY_TRACE
+    unsigned seen[8]={0};
+    for(const RBTreeArrayTraceRecord& record:records){
+        seen[static_cast<int>(record.event)]=seen[static_cast<int>(record.event)]+1;
+    }
+    const RBTreeArrayTraceRecord& last=records.back();
+    bool traced=seen[static_cast<int>(RBTreeArrayTraceEvent::Grow)]>=5&&seen[static_cast<int>(RBTreeArrayTraceEvent::ReSize)]==1
+        &&seen[static_cast<int>(RBTreeArrayTraceEvent::MemoryShrink)]==1&&seen[static_cast<int>(RBTreeArrayTraceEvent::Transform)]==1
+        &&seen[static_cast<int>(RBTreeArrayTraceEvent::ConditionalDeleteByKeys)]==1&&seen[static_cast<int>(RBTreeArrayTraceEvent::ConditionalDeleteInOrder)]==1
+        &&seen[static_cast<int>(RBTreeArrayTraceEvent::ConditionalDeleteRebuild)]==1
+        &&last.event==RBTreeArrayTraceEvent::Rebuild&&last.nodes==tree.KeyCount()&&last.tree==&another;
+#else
+    bool traced=records.empty();
+#endif
+    if(!traced){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("TraceTest passed\n========================\n");
+}
+
+void RecordTest(){
+    FILE* file=tmpfile();
+    RBTreeArray32<std::string,int64_t> tree={{"b",-2},{"a",1}};
+    RBTreeArrayRecorder recorder(file);
+    bool attached=tree.SetRecorder(&recorder);
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,7);
+    for(unsigned index=0;index<20000;index=index+1){
+        std::string key="k"+std::to_string(PCG32Uniform(&PCGStatus,0,999));
+        unsigned operation=PCG32Uniform(&PCGStatus,0,9);
+        std::string another;
+        int64_t value;
+        if(operation<4){
+            tree.Insert(key,int64_t(PCG32(&PCGStatus))-2000000000);
+        }else if(operation==4){
+            tree.Delete(key);
+        }else if(operation==5){
+            tree.Search(key,value);
+        }else if(operation==6){
+            value=tree[key];
+        }else if(operation==7){
+            tree.GetSmallestGraterThan(key,another,value);
+        }else if(operation==8){
+            tree.GetBiggestSmallerThan(key,another,value);
+        }else{
+            tree.Neighbors(key);
+        }
+    }
+    tree.ConditionalDelete([](const std::string& key,int64_t value){return key.back()=='7';});
+    tree.ConditionalDeleteOnce([](const std::string& key,int64_t value){return value<0;});
+    // calls that replace the content or the array
+    tree.MemoryShrink();
+    RBTreeArray32<std::string,int64_t> replacement={{"x",5},{"y",-6},{"k1",7}};
+    tree=replacement;
+    tree.Insert("z",8);
+    tree=std::move(replacement);
+    tree.ReSize(1000);
+    tree.Insert("w",9);
+    tree.SetRecorder(nullptr);
+    tree.Insert("not recorded",0);
+    tree.Delete("not recorded");
+    recorder.Flush();
+
+    std::vector<char> buffer;
+    fseek(file,0,SEEK_SET);
+    char chunk[4096];
+    size_t readed;
+    while((readed=fread(chunk,1,sizeof(chunk),file))>0){
+        buffer.insert(buffer.end(),chunk,chunk+readed);
+    }
+    fclose(file);
+#if RBTREE_ARRAY_RECORD
+    RBTreeArrayRecordReader reader(buffer.data(),buffer.size());
+    std::map<std::string,int64_t> map;
+    RBTreeArray64<std::string,int64_t> replica;
+    RBTreeArrayRecordOperation operation;
+    uint64_t nanoseconds;
+    uint64_t elapsed=0;
+    uint64_t records=0;
+    uint64_t resizes=0;
+    std::string key,another;
+    int64_t value;
+    while(reader.Next(operation,nanoseconds,key,value)){
+        elapsed=elapsed+nanoseconds;
+        records=records+1;
+        switch(operation){
+        case RBTreeArrayRecordOperation::Load:
+        case RBTreeArrayRecordOperation::Insert:
+            map[key]=value;
+            replica.Insert(key,value);
+            break;
+        case RBTreeArrayRecordOperation::Delete:
+            map.erase(key);
+            replica.Delete(key);
+            break;
+        case RBTreeArrayRecordOperation::Access:
+            map[key];
+            replica[key];
+            break;
+        case RBTreeArrayRecordOperation::Clear:
+            map.clear();
+            replica.Clear();
+            break;
+        case RBTreeArrayRecordOperation::ReSize:
+            replica.ReSize(reader.Size());
+            resizes=resizes+1;
+            break;
+        default:
+            replica.Search(key,value);
+            break;
+        }
+    }
+    // KeysValues() is in node array order
+    std::vector<std::pair<std::string,int64_t>> recorded=tree.KeysValues();
+    std::vector<std::pair<std::string,int64_t>> replayedPairs=replica.KeysValues();
+    std::sort(recorded.begin(),recorded.end());
+    std::sort(replayedPairs.begin(),replayedPairs.end());
+    bool replayed=attached&&reader.Matches<std::string,int64_t>()&&!reader.Matches<std::string,uint64_t>()&&reader.End()
+        &&records==recorder.RecordCount()&&records>20000&&elapsed>0&&resizes==2&&replica.ArraySize()==1000&&tree.KeyCount()==4
+        &&recorded==replayedPairs&&recorded==std::vector<std::pair<std::string,int64_t>>(map.begin(),map.end());
+#else
+    bool replayed=!attached&&buffer.empty()&&recorder.RecordCount()==0&&tree.SetRecorder(nullptr);
+#endif
+    // the encoding is available without RBTREE_ARRAY_RECORD
+    FILE* directFile=tmpfile();
+    {
+        RBTreeArrayRecorder direct(directFile);
+        const int32_t keys[]={0,-1,1,-2147483647-1,2147483647};
+        const double values[]={0.5,-0.25,1e300,0,3};
+        direct.Begin<int32_t,double>();
+        for(unsigned index=0;index<5;index=index+1){
+            direct.Record(RBTreeArrayRecordOperation::Insert,keys+index,values+index);
+        }
+        direct.Record(RBTreeArrayRecordOperation::Clear,(const int32_t*)nullptr,(const double*)nullptr);
+        direct.Flush();
+        buffer.clear();
+        fseek(directFile,0,SEEK_SET);
+        while((readed=fread(chunk,1,sizeof(chunk),directFile))>0){
+            buffer.insert(buffer.end(),chunk,chunk+readed);
+        }
+        RBTreeArrayRecordReader reader(buffer.data(),buffer.size()-1);
+        RBTreeArrayRecordOperation operation;
+        uint64_t nanoseconds;
+        int32_t key;
+        double value;
+        for(unsigned index=0;index<5;index=index+1){
+            if(!reader.Next(operation,nanoseconds,key,value)||operation!=RBTreeArrayRecordOperation::Insert||key!=keys[index]||value!=values[index]){
+                replayed=false;
+            }
+        }
+        // the Clear record was cut off
+        if(reader.Next(operation,nanoseconds,key,value)||reader.End()||!reader.Matches<int32_t,double>()){
+            replayed=false;
+        }
+    }
+    fclose(directFile);
+    if(!replayed){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("RecordTest passed\n========================\n");
+}
+
+void AllocationHookTest(){
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+    const long long blocksBefore=testHeapBlocks;
+    const unsigned long long allocationsBefore=testHeapAllocations;
+    {
+        RBTreeArray32<uint64_t,uint32_t> tree32;
+        std::map<uint64_t,uint32_t> map;
+        for(unsigned index=0;index<50000;index=index+1){
+            uint64_t key=PCG32Uniform(&PCGStatus,0,200000);
+            tree32.Insert(key,index);
+            map[key]=index;
+        }
+        tree32.ConditionalDelete([](uint64_t key,uint32_t value){return key%7==0;});
+        tree32.ConditionalDelete([](uint64_t key,uint32_t value){return key%2==0;});
+        for(auto iterator=map.begin();iterator!=map.end();){
+            if(iterator->first%7==0||iterator->first%2==0){
+                iterator=map.erase(iterator);
+            }
+            else{
+                ++iterator;
+            }
+        }
+        tree32.MemoryShrink();
+        std::vector<char> stream;
+        bool exported=tree32.ExportSorted([&](const void* data,uint64_t byteSize){
+            stream.insert(stream.end(),(const char*)data,(const char*)data+byteSize);
+            return true;
+        },1000,true);
+        uint64_t position=0;
+        RBTreeArray64<uint64_t,uint32_t> tree64;
+        tree64.SetIncrementalGrowth(64);
+        for(uint64_t key=0;key<5000;key=key+1){
+            tree64.Insert(key,0);
+        }
+        bool imported=tree64.ImportSorted([&](void* data,uint64_t byteSize){
+            if(stream.size()-position<byteSize){
+                return false;
+            }
+            memcpy(data,stream.data()+position,byteSize);
+            position=position+byteSize;
+            return true;
+        });
+        if(!exported||!imported||!NodeCompare(tree32,map)||!NodeCompare(tree64,map)||testHeapBlocks<=blocksBefore){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        tree32.Clear();
+        tree32.MemoryShrink();
+    }
+    if(testHeapBlocks!=blocksBefore||testHeapAllocations==allocationsBefore){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("AllocationHookTest passed\n========================\n");
+}
+
+void PCG32StreamTest(){
+    const long long unsigned int seed=time(NULL);
+    PCG32Struct classic,stream,other;
+    PCG32SetSeed(&classic,seed);
+    PCG32SetStream(&stream,seed,PCG32DefaultStream);
+    PCG32SetStream(&other,seed,12345);
+    unsigned sameAsOther=0;
+    for(unsigned index=0;index<1000;index=index+1){
+        unsigned number=PCG32(&classic);
+        if(number!=PCG32(&stream)){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, PCG32 error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        sameAsOther=sameAsOther+(number==PCG32(&other));
+    }
+    const long long unsigned int deltas[]={0,1,7,1000,123457};
+    for(long long unsigned int delta:deltas){
+        PCG32Struct stepped=other,jumped=other;
+        for(long long unsigned int index=0;index<delta;index=index+1){
+            PCG32(&stepped);
+        }
+        PCG32Advance(&jumped,delta);
+        PCG32Struct back=jumped;
+        PCG32Advance(&back,0-delta);
+        if(stepped.state!=jumped.state||back.state!=other.state||PCG32(&stepped)!=PCG32(&jumped)){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, PCG32 error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    const long long unsigned int counts[]={0,5,31,32,33,1000,1003};
+    for(long long unsigned int count:counts){
+        PCG32Struct filled=other,called=other;
+        std::vector<unsigned> numbers(count+1);
+        std::vector<long long unsigned int> wide(count+1);
+        PCG32Fill(&filled,numbers.data(),count);
+        bool same=true;
+        for(long long unsigned int index=0;index<count;index=index+1){
+            same=same&&numbers[index]==PCG32(&called);
+        }
+        PCG32Fill64(&filled,wide.data(),count);
+        for(long long unsigned int index=0;index<count;index=index+1){
+            long long unsigned int high=PCG32(&called);
+            same=same&&wide[index]==((high<<32)|PCG32(&called));
+        }
+        if(!same||filled.state!=called.state){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, PCG32 error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    std::vector<unsigned> oneThread(300000),threeThreads;
+    for(unsigned index=0;index<oneThread.size();index=index+1){
+        oneThread[index]=index;
+    }
+    threeThreads=oneThread;
+    PCG32Struct first=other,second=other;
+    PCG32ParallelUniformShuffle(&first,oneThread.data(),oneThread.size(),1);
+    PCG32ParallelUniformShuffle(&second,threeThreads.data(),threeThreads.size(),3);
+    unsigned fixedPoints=0;
+    for(unsigned index=0;index<oneThread.size();index=index+1){
+        fixedPoints=fixedPoints+(oneThread[index]==index);
+    }
+    std::vector<unsigned> sorted=oneThread;
+    std::sort(sorted.begin(),sorted.end());
+    bool permutation=true;
+    for(unsigned index=0;index<sorted.size();index=index+1){
+        permutation=permutation&&sorted[index]==index;
+    }
+    // a uniform permutation has about one fixed point
+    if(sameAsOther>10||oneThread!=threeThreads||!permutation||fixedPoints>20||first.state!=second.state){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, PCG32 error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("PCG32StreamTest passed\n========================\n");
+}
+
+template<typename RBTreeArray,typename KeyType>
+void BranchlessDescentCheck(RBTreeArray& tree,const std::map<KeyType,int>& map,KeyType probe){
+    int value;
+    KeyType key;
+    bool found=tree.Search(probe,value);
+    auto exact=map.find(probe);
+    auto greater=map.upper_bound(probe);
+    auto notLess=map.lower_bound(probe);
+    bool hasSmaller=notLess!=map.begin();
+    auto smaller=hasSmaller?std::prev(notLess):map.end();
+    auto neighbors=tree.Neighbors(probe);
+    auto floor=exact!=map.end()?exact:smaller;
+    auto ceiling=notLess;
+    bool same=found==(exact!=map.end())&&(!found||value==exact->second);
+    same=same&&tree.GetSmallestGraterThan(probe,key,value)==(greater!=map.end())&&(greater==map.end()||key==greater->first);
+    same=same&&tree.GetBiggestSmallerThan(probe,key,value)==hasSmaller&&(!hasSmaller||key==smaller->first);
+    same=same&&(neighbors.first==tree.OrderedEnd())==(floor==map.end())&&(floor==map.end()||(*neighbors.first).first==floor->first);
+    same=same&&(neighbors.second==tree.OrderedEnd())==(ceiling==map.end())&&(ceiling==map.end()||(*neighbors.second).first==ceiling->first);
+    if(!same){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+}
+
+void BranchlessDescentTest(){
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+    RBTreeArray16<int16_t,int> tree16;
+    RBTreeArray64<double,int> tree64;
+    std::map<int16_t,int> map16;
+    std::map<double,int> map64;
+    for(unsigned index=0;index<20000;index=index+1){
+        int16_t key16=(int16_t)PCG32Uniform(&PCGStatus,0,4000)-2000;
+        double key64=PCG32UniformReal(&PCGStatus,-1000,1000);
+        tree16.Insert(key16,index);
+        map16[key16]=index;
+        tree64.Insert(key64,index);
+        map64[key64]=index;
+        if(PCG32(&PCGStatus)%3==0){
+            tree16.Delete(key16/2);
+            map16.erase(key16/2);
+        }
+    }
+    for(unsigned index=0;index<20000;index=index+1){
+        BranchlessDescentCheck(tree16,map16,(int16_t)((int16_t)PCG32Uniform(&PCGStatus,0,4400)-2200));
+        BranchlessDescentCheck(tree64,map64,PCG32UniformReal(&PCGStatus,-1100,1100));
+        auto existing=map64.begin();
+        std::advance(existing,PCG32Uniform(&PCGStatus,0,9)%map64.size());
+        BranchlessDescentCheck(tree64,map64,existing->first);
+    }
+    RBTreeArray32<double,int> empty;
+    std::map<double,int> emptyMap;
+    BranchlessDescentCheck(empty,emptyMap,1.0);
+    printf("BranchlessDescentTest passed\n========================\n");
+}
+
+std::string KeyPrefixRandomKey(PCG32Struct* PCGStatus){
+    // few letters and lengths around 8 so that most keys tie on their cached prefix
+    static const char letters[]={'\0','a','b','\x7f','\x80','\xff'};
+    std::string key(PCG32Uniform(PCGStatus,0,12),'a');
+    for(unsigned index=0;index<key.size();index=index+1){
+        key[index]=letters[PCG32Uniform(PCGStatus,0,5)];
+    }
+    return key;
+}
+
+// own key with a cached prefix, the prefixed descent is tested whether or not RBTREE_ARRAY_KEY_PREFIX is set
+struct PrefixedKey{
+    uint32_t high;
+    uint32_t low;
+    bool operator<(const PrefixedKey& another)const{return high!=another.high?high<another.high:low<another.low;}
+    bool operator>(const PrefixedKey& another)const{return another<*this;}
+    bool operator==(const PrefixedKey& another)const{return high==another.high&&low==another.low;}
+    bool operator!=(const PrefixedKey& another)const{return !(*this==another);}
+};
+
+template<>
+struct RBTreeArrayKeyPrefix<PrefixedKey>:public std::true_type{
+    static uint64_t Get(const PrefixedKey& key)noexcept{return key.high;}
+};
+
+void KeyPrefixTest(){
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+    RBTreeArray16<std::string,int> tree16;
+    RBTreeArray32<std::string,int> tree32;
+    std::map<std::string,int> map;
+    for(unsigned index=0;index<20000;index=index+1){
+        std::string key=KeyPrefixRandomKey(&PCGStatus);
+        tree16.Insert(key,index);
+        tree32[key]=index;
+        map[key]=index;
+        if(PCG32(&PCGStatus)%3==0){
+            key=KeyPrefixRandomKey(&PCGStatus);
+            tree16.Delete(key);
+            tree32.Delete(key);
+            map.erase(key);
+        }
+    }
+    RBTreeArray64<std::string,int> tree64(map.size());
+    for(auto& pair:map){
+        tree64.Insert(pair.first,pair.second);
+    }
+    if(!tree32.MemoryShrink()){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    RBTreeArray32<std::string,int> copy(tree32);
+    for(unsigned index=0;index<20000;index=index+1){
+        std::string probe=KeyPrefixRandomKey(&PCGStatus);
+        BranchlessDescentCheck(tree16,map,probe);
+        BranchlessDescentCheck(tree32,map,probe);
+        BranchlessDescentCheck(tree64,map,probe);
+        BranchlessDescentCheck(copy,map,probe);
+    }
+    if(tree16.Keys().size()!=map.size()||tree32.KeyCount()!=map.size()||!std::equal(map.begin(),map.end(),copy.OrderedBegin(),
+        [](const std::pair<const std::string,int>& expected,const std::pair<std::string,int>& pair){return expected.first==pair.first&&expected.second==pair.second;})){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    RBTreeArray32<PrefixedKey,int> prefixedTree;
+    std::map<PrefixedKey,int> prefixedMap;
+    for(unsigned index=0;index<20000;index=index+1){
+        PrefixedKey key={PCG32(&PCGStatus)%16,PCG32(&PCGStatus)%1000};
+        if(PCG32(&PCGStatus)%3==0){
+            prefixedTree.Delete(key);
+            prefixedMap.erase(key);
+        }else{
+            prefixedTree.Insert(key,index);
+            prefixedMap[key]=index;
+        }
+    }
+    for(const auto& pair:prefixedMap){
+        int value;
+        if(!prefixedTree.Search(pair.first,value)||value!=pair.second){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    if(!NodeCompare(prefixedTree,prefixedMap)){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("KeyPrefixTest passed\n========================\n");
+}
+
+template<unsigned Capacity>
+void FixedStringCompareCheck(PCG32Struct* PCGStatus){
+    for(unsigned index=0;index<20000;index=index+1){
+        std::string first=KeyPrefixRandomKey(PCGStatus);
+        std::string second=PCG32(PCGStatus)%4?KeyPrefixRandomKey(PCGStatus):first;
+        first.resize(first.size()<Capacity?first.size():Capacity);
+        second.resize(second.size()<Capacity?second.size():Capacity);
+        int expected=first.compare(second);
+        int result=RBTreeArrayFixedString<Capacity>::Compare(first,second);
+        if((expected<0)!=(result<0)||(expected>0)!=(result>0)||RBTreeArrayFixedString<Capacity>(first).ToString()!=first){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+}
+
+// trivially copyable, but its default constructor is not trivial
+struct InitializedValue{
+    uint32_t first=7;
+    uint32_t second=9;
+};
+
+void TrivialNodeTest(){
+    static_assert(RBTreeArrayIsTrivialNode<uint32_t,uint64_t>::value&&RBTreeArrayIsBytewiseNode<uint32_t,uint64_t>::value,"RBTreeArrayIsTrivialNode");
+    static_assert(std::is_trivially_copyable<InitializedValue>::value&&!RBTreeArrayIsTrivialNode<uint32_t,InitializedValue>::value
+        &&!RBTreeArrayIsBytewiseNode<uint32_t,InitializedValue>::value,"RBTreeArrayIsTrivialNode");
+    static_assert(!RBTreeArrayIsTrivialNode<uint32_t,RBTreeArrayFixedString<23>>::value,"RBTreeArrayIsTrivialNode");
+    RBTreeArray32<uint32_t,InitializedValue> tree;
+    tree.SetIncrementalGrowth(16);
+    for(uint32_t key=0;key<5000;key=key+1){
+        InitializedValue& value=tree[key];
+        if(value.first!=7||value.second!=9){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+        value.second=key;
+    }
+    for(uint32_t key=0;key<5000;key=key+1){
+        InitializedValue value;
+        if(!tree.Search(key,value)||value.first!=7||value.second!=key){
+            char errorMassage[1024];
+            sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+            throw std::logic_error(errorMassage);
+        }
+    }
+    printf("TrivialNodeTest passed\n========================\n");
+}
+
+void FixedStringTest(){
+    typedef RBTreeArrayFixedString<23> FixedString;
+    static_assert(std::is_trivially_copyable<FixedString>::value&&sizeof(FixedString)==24,"RBTreeArrayFixedString layout");
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+    FixedStringCompareCheck<7>(&PCGStatus);
+    FixedStringCompareCheck<23>(&PCGStatus);
+    FixedStringCompareCheck<40>(&PCGStatus);
+    RBTreeArray32<FixedString,int> tree;
+    std::map<std::string,int> map;
+    for(unsigned index=0;index<20000;index=index+1){
+        std::string key=KeyPrefixRandomKey(&PCGStatus);
+        tree.Insert(key,index);
+        map[key]=index;
+        if(PCG32(&PCGStatus)%3==0){
+            key=KeyPrefixRandomKey(&PCGStatus);
+            tree.Delete(key);
+            map.erase(key);
+        }
+    }
+    RBTree* treeCopy=(RBTree*)malloc(tree.ByteSize());
+    memcpy(treeCopy,tree.Data(),tree.ByteSize());
+    RBTreeArray32<FixedString,int> reloaded(1);
+    std::string prefix("ab");
+    uint64_t prefixCount=0;
+    for(auto& pair:map){
+        prefixCount=prefixCount+(pair.first.compare(0,prefix.size(),prefix)==0);
+    }
+    if(!reloaded.SetTree(treeCopy)||reloaded.KeyCount()!=map.size()||reloaded.PrefixRange(prefix).Count()!=prefixCount||!std::equal(map.begin(),map.end(),reloaded.OrderedBegin(),
+        [](const std::pair<const std::string,int>& expected,const std::pair<FixedString,int>& pair){return expected.first==pair.first.ToString()&&expected.second==pair.second;})){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    bool thrown=false;
+    try{
+        FixedString tooLong(std::string(24,'a'));
+    }catch(const std::length_error&){
+        thrown=true;
+    }
+    if(!thrown){
+        char errorMassage[1024];
+        sprintf(errorMassage,"in %s: %d, RBTreeArray error",__FUNCTION__,__LINE__);
+        throw std::logic_error(errorMassage);
+    }
+    printf("FixedStringTest passed\n========================\n");
+}
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+void getDetailedMemoryInfo() {
+    // 从 /proc/self/statm 获取详细信息
+    FILE *fp = fopen("/proc/self/status", "r");
+    if (!fp) {
+        perror("fopen");
+        return;
+    }
+    
+    char line[256];
+    long vmrss_kb = 0;
+    long vmhwm_kb = 0;
+    long vmsize_kb = 0;
+    long vmswap_kb = 0;
+    
+    while (fgets(line, sizeof(line), fp)) {
+        // 当前物理内存使用
+        if (strncmp(line, "VmRSS:", 6) == 0) {
+            sscanf(line + 6, "%ld", &vmrss_kb);
+        }
+        // 物理内存峰值
+        else if (strncmp(line, "VmHWM:", 6) == 0) {
+            sscanf(line + 6, "%ld", &vmhwm_kb);
+        }
+        // 虚拟内存大小
+        else if (strncmp(line, "VmSize:", 7) == 0) {
+            sscanf(line + 7, "%ld", &vmsize_kb);
+        }
+        // SWAP使用量
+        else if (strncmp(line, "VmSwap:", 7) == 0) {
+            sscanf(line + 7, "%ld", &vmswap_kb);
+        }
+        // 数据段大小
+        else if (strncmp(line, "VmData:", 7) == 0) {
+            long vmdata_kb;
+            sscanf(line + 7, "%ld", &vmdata_kb);
+            // printf("数据段大小: %ld KB\n", vmdata_kb);
+        }
+        // 栈大小
+        else if (strncmp(line, "VmStk:", 6) == 0) {
+            long vmstk_kb;
+            sscanf(line + 6, "%ld", &vmstk_kb);
+            // printf("栈大小: %ld KB\n", vmstk_kb);
+        }
+    }
+    
+    fclose(fp);
+    
+    printf("\n=== 实时内存状态 ===\n");
+    printf("当前物理内存(VmRSS): %ld KB (%.2f MB)\n", 
+           vmrss_kb, vmrss_kb / 1024.0);
+    printf("物理内存峰值(VmHWM): %ld KB (%.2f MB)\n", 
+           vmhwm_kb, vmhwm_kb / 1024.0);
+    printf("虚拟内存大小(VmSize): %ld KB (%.2f MB)\n", 
+           vmsize_kb, vmsize_kb / 1024.0);
+    if (vmswap_kb > 0) {
+        printf("SWAP使用量(VmSwap): %ld KB\n", vmswap_kb);
+    }
+}
+
+void PrintMemoryUsage(const RBTreeArrayMemoryUsage& usage){
+    printf("block: %llu bytes, live: %llu, unused: %llu, padding: %llu, nested: %llu, total: %llu\n",
+        (long long unsigned int)usage.blockBytes,(long long unsigned int)usage.liveBytes,(long long unsigned int)usage.unusedBytes,
+        (long long unsigned int)usage.paddingBytes,(long long unsigned int)usage.nestedBytes,(long long unsigned int)usage.totalBytes);
+}
+
+void MemoryTest(){
+    RBTreeArray32<std::string,std::vector<std::string>> tree;
+    PCG32Struct PCGStatus;
+    PCG32SetSeed(&PCGStatus,time(NULL));
+    getDetailedMemoryInfo();
+
+    unsigned insertTimes=1<<23;
+    for(unsigned index=0;index<insertTimes;index=index+1){
+        tree.Insert(std::to_string(PCG32(&PCGStatus)),{std::to_string(PCG32(&PCGStatus)),std::to_string(PCG32UniformReal(&PCGStatus,0,3.1415926535))});
+    }
+    tree.MemoryShrink();
+    getDetailedMemoryInfo();
+    PrintMemoryUsage(tree.MemoryUsage());
+    for(unsigned index=0;index<insertTimes;index=index+1){
+        if(PCG32(&PCGStatus)&1){
+            tree.Insert(std::to_string(PCG32(&PCGStatus)),{std::to_string(PCG32(&PCGStatus)),std::to_string(PCG32UniformReal(&PCGStatus,0,3.1415926535))});
+        }else{
+            std::string search=std::to_string(PCG32(&PCGStatus));
+            std::string toDelete;
+            std::vector<std::string> value;
+            if(tree.GetBiggestSmallerThan(search,toDelete,value)){
+
+            }else{
+                tree.GetSmallestGraterThan(search,toDelete,value);
+            }
+            tree.Delete(toDelete);
+        }
+    }
+    tree.MemoryShrink();
+    getDetailedMemoryInfo();
+    PrintMemoryUsage(tree.MemoryUsage());
+    tree.Clear();
+    tree.MemoryShrink();
+    getDetailedMemoryInfo();
+    PrintMemoryUsage(tree.MemoryUsage());
+}
+
+int main() {
+    TestRBTreeArray tester;
+    tester.runAllTests();
+    
+    BoundaryTest();
+
+    IteratorTest();
+    SpecialTestConditionalDelete();
+    SecondaryIndexTest();
+    PrefixRangeTest();
+    NearestTest();
+    ScanWhereTest();
+    ViewTest();
+    ExportImportSortedTest();
+    CompactSnapshotTest();
+    PagedTest();
+    MappedTest();
+    DirtyFlushTest();
+    IncrementalGrowthTest();
+    StatisticsTest();
+    MemoryUsageTest();
+    TraceTest();
+    RecordTest();
+    AllocationHookTest();
+    PCG32StreamTest();
+    BranchlessDescentTest();
+    KeyPrefixTest();
+    TrivialNodeTest();
+    FixedStringTest();
+    
+    SpeedTest();
+
+    // MemoryTest();
+    return 0;
 }
\ No newline at end of file